@@ -0,0 +1,468 @@
+// Build: g++ -std=c++17 -O2 bench.cpp leaderboard.cpp -o bench -lpthread
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <filesystem>
+#include <new>
+#include <thread>
+#include <unistd.h>
+
+#include "gameserver.h"
+#include "gamejson.h"
+
+using namespace std;
+
+// ============================================================================
+// BENCHMARKS
+// ============================================================================
+//
+// Drives the GameServer hot paths against a synthetic population and prints
+// one line per benchmark: average ns/op, heap allocations/op and p50/p99/p999
+// latency in ns. Every call is timed on its own, so the ns/op column includes
+// the clock overhead (roughly 20-40 ns).
+//
+//   bench [--players 1000,100000] [--ops 100000] [--only <name>]
+//         [--dir <scratch dir>] [--log-level <level>] [--seed <n>]
+//         [--columnar] [--store] [--max-resident <n>]
+//
+// The population is written to a pack file and bulk loaded, so even
+// --players 10000000 is ready in seconds (allow ~1 GB of RAM per million).
+// Save/load benchmarks write <name>.sav files into the scratch directory,
+// or with --store append to a packed save store in <scratch dir>/store.
+// --max-resident (needs --store) caps the players kept in memory, so the
+// per-player benchmarks mix registry hits with faults from the store.
+// topBy and decayHeat are whole-population passes and run at most 10 times;
+// --columnar runs them (and everything else) with the column store enabled.
+
+// ============================================================================
+// ALLOCATION COUNTER
+// ============================================================================
+
+static atomic<uint64_t> allocationCount(0);
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1)) {
+        return p;
+    }
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+// GCC cannot see that the replacement new above pairs with free()
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+// ============================================================================
+// POPULATION
+// ============================================================================
+
+static string playerName(size_t i) {
+    return "p" + to_string(i);
+}
+
+// Deterministic mid-game player; plenty of credits so purchases and
+// upgrades take their success path
+static Player syntheticPlayer(size_t i, const vector<string>& paths) {
+    Player player;
+    player.username = playerName(i);
+    player.characterType = (i % 2) ? SYM_GHOST : SYM_CIPHER;
+    player.level = 1 + (int)(i % 19);
+    player.xp = (int)(i % 97);
+    player.credits = 1000000000;
+    player.reputation = (int)(i % 5000);
+    player.heat = (int)(i % 40);
+    player.maxHeat = player.heat;
+    player.storyPath = intern(paths[i % paths.size()]);
+    player.totalEarned = (int)(i % 100000);
+    return player;
+}
+
+// Bytes in the packed save store under the scratch directory
+static uintmax_t storeBytes() {
+    uintmax_t total = 0;
+    error_code ec;
+    for (const auto& entry : filesystem::directory_iterator("store", ec)) {
+        total += entry.file_size(ec);
+    }
+    return total;
+}
+
+// Loads count synthetic players into server through a pack file
+static bool buildPopulation(GameServer& server, size_t count, const string& packPath) {
+    vector<string> paths = GameData::getStoryPaths();
+    FILE* file = fopen(packPath.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    string buffer;
+    SaveFile::encodePackHeader(buffer);
+    for (size_t i = 0; i < count; i++) {
+        SaveFile::encode(syntheticPlayer(i, paths), buffer);
+        if (buffer.size() >= (1 << 20)) {
+            fwrite(buffer.data(), 1, buffer.size(), file);
+            buffer.clear();
+        }
+    }
+    fwrite(buffer.data(), 1, buffer.size(), file);
+    fclose(file);
+
+    long loaded = server.loadPack(packPath);
+    remove(packPath.c_str());
+    return loaded == (long)count;
+}
+
+// ============================================================================
+// RUNNER
+// ============================================================================
+
+struct BenchResult {
+    double nsPerOp;
+    double allocsPerOp;
+    uint64_t p50;
+    uint64_t p99;
+    uint64_t p999;
+};
+
+// Times op(i) for i in [0, ops). setup(i), if given, runs untimed before
+// each call.
+static BenchResult runBench(size_t ops, const function<void(size_t)>& op,
+                            const function<void(size_t)>& setup = nullptr) {
+    vector<uint64_t> samples(ops);
+    uint64_t allocations = 0;
+    uint64_t total = 0;
+
+    for (size_t i = 0; i < ops; i++) {
+        if (setup) setup(i);
+        uint64_t before = allocationCount.load(memory_order_relaxed);
+        auto start = chrono::steady_clock::now();
+        op(i);
+        auto end = chrono::steady_clock::now();
+        allocations += allocationCount.load(memory_order_relaxed) - before;
+        samples[i] = (uint64_t)chrono::duration_cast<chrono::nanoseconds>(end - start).count();
+        total += samples[i];
+    }
+
+    BenchResult result;
+    result.nsPerOp = ops ? (double)total / ops : 0;
+    result.allocsPerOp = ops ? (double)allocations / ops : 0;
+    sort(samples.begin(), samples.end());
+    auto percentile = [&](double q) {
+        return samples.empty() ? 0 : samples[min(samples.size() - 1, (size_t)(q * samples.size()))];
+    };
+    result.p50 = percentile(0.50);
+    result.p99 = percentile(0.99);
+    result.p999 = percentile(0.999);
+    return result;
+}
+
+static void printHeader(size_t players, size_t ops) {
+    cout << "\nplayers=" << players << " ops=" << ops << endl;
+    cout << left << setw(22) << "benchmark" << right
+         << setw(14) << "ns/op" << setw(12) << "allocs/op"
+         << setw(12) << "p50" << setw(12) << "p99" << setw(12) << "p999" << endl;
+}
+
+static void printResult(const string& name, const BenchResult& r) {
+    cout << left << setw(22) << name << right << fixed
+         << setw(14) << setprecision(1) << r.nsPerOp
+         << setw(12) << setprecision(2) << r.allocsPerOp
+         << setw(12) << r.p50 << setw(12) << r.p99 << setw(12) << r.p999 << endl;
+}
+
+static vector<size_t> parseSizes(const string& list) {
+    vector<size_t> sizes;
+    size_t start = 0;
+    while (start < list.size()) {
+        size_t comma = list.find(',', start);
+        if (comma == string::npos) comma = list.size();
+        size_t n = strtoull(list.c_str() + start, nullptr, 10);
+        if (n > 0) sizes.push_back(n);
+        start = comma + 1;
+    }
+    return sizes;
+}
+
+// ============================================================================
+// SUITE
+// ============================================================================
+
+// Runs in the scratch directory, which receives the save files
+static void runSuite(size_t population, size_t ops, const string& only, uint64_t seed, bool columnar,
+                     bool packedStore, size_t maxResident) {
+    GameServer server;
+    server.setSeed(seed);
+    if (columnar) {
+        server.enableColumns();
+    }
+    if (packedStore) {
+        error_code ec;
+        filesystem::remove_all("store", ec);
+        if (server.enableStore("store") < 0) {
+            cout << "ERROR: Could not open the save store" << endl;
+            return;
+        }
+    }
+    if (maxResident > 0 && !server.limitResidentPlayers(maxResident)) {
+        cout << "ERROR: --max-resident needs --store" << endl;
+        return;
+    }
+    if (!buildPopulation(server, population, "population.pack")) {
+        cout << "ERROR: Could not build a population of " << population << endl;
+        return;
+    }
+    // Let the evictor write the bulk load back before anything is timed
+    while (maxResident > 0 && server.residentPlayers() > maxResident) {
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    server.flushSaves();
+
+    // Names are built up front so the timed calls only pay for GameServer
+    vector<string> names(population);
+    for (size_t i = 0; i < population; i++) {
+        names[i] = playerName(i);
+    }
+    auto pick = [&](size_t i) -> const string& {
+        return names[(i * 2654435761u) % population];
+    };
+
+    // Detached players for the helpers that take a Player directly
+    vector<string> paths = GameData::getStoryPaths();
+    vector<Player> samples;
+    for (size_t i = 0; i < min(population, (size_t)4096); i++) {
+        samples.push_back(syntheticPlayer(i, paths));
+    }
+
+    vector<ShopItem> items = GameData::getShopItems();
+    const char* skills[] = {"hacking", "cryptography", "networking", "programming"};
+    size_t saveSpan = min(population, (size_t)1024);
+
+    printHeader(population, ops);
+    auto want = [&](const string& name) { return only.empty() || only == name; };
+
+    if (want("getAvailableMissions")) {
+        volatile size_t sink = 0;
+        printResult("getAvailableMissions", runBench(ops, [&](size_t i) {
+            sink = sink + server.getAvailableMissions(samples[i % samples.size()]).size();
+        }));
+    }
+
+    if (want("checkAchievements")) {
+        printResult("checkAchievements", runBench(ops, [&](size_t i) {
+            server.checkAchievements(samples[i % samples.size()]);
+        }, [&](size_t i) {
+            Player& player = samples[i % samples.size()];
+            player.achievements.reset();
+            player.dirtyFields = FIELD_ALL;
+        }));
+    }
+
+    if (want("startMission")) {
+        // Mission ids advance once per population-sized pass, so repeat
+        // visits mostly meet a mission the player has not done yet
+        printResult("startMission", runBench(ops, [&](size_t i) {
+            server.startMission(pick(i), 1 + (int)((i / population) % 20), 80);
+        }));
+    }
+
+    if (want("buyItem")) {
+        printResult("buyItem", runBench(ops, [&](size_t i) {
+            server.buyItem(pick(i), symbolName(items[(i / population) % items.size()].id));
+        }));
+    }
+
+    if (want("upgradeSkill")) {
+        printResult("upgradeSkill", runBench(ops, [&](size_t i) {
+            server.upgradeSkill(pick(i), skills[i % 4]);
+        }));
+    }
+
+    if (want("getPlayerStats")) {
+        printResult("getPlayerStats", runBench(ops, [&](size_t i) {
+            server.getPlayerStats(pick(i));
+        }));
+    }
+
+    if (want("renderPlayerStats")) {
+        string& out = scratchBuffer();
+        printResult("renderPlayerStats", runBench(ops, [&](size_t i) {
+            out.clear();
+            server.renderPlayerStats(pick(i), out);
+        }));
+    }
+
+    if (want("renderPlayerStatsJson")) {
+        string& out = scratchBuffer();
+        printResult("renderPlayerStatsJson", runBench(ops, [&](size_t i) {
+            out.clear();
+            server.renderPlayerStatsJson(pick(i), out);
+        }));
+    }
+
+    // DOM counterparts of the streamed responses, to keep the fast path honest
+    if (want("playerJsonDom")) {
+        volatile size_t sink = 0;
+        printResult("playerJsonDom", runBench(ops, [&](size_t i) {
+            Player player;
+            server.exportPlayer(pick(i), player);
+            sink = sink + json(player).dump().size();
+        }));
+    }
+
+    if (want("missionsJson")) {
+        string& out = scratchBuffer();
+        printResult("missionsJson", runBench(ops, [&](size_t) {
+            out.clear();
+            server.renderMissionsJson("", out);
+        }));
+    }
+
+    if (want("missionsJsonDom")) {
+        volatile size_t sink = 0;
+        printResult("missionsJsonDom", runBench(ops, [&](size_t) {
+            json missions = json::array();
+            for (const Mission* mission : server.getRules().getAllMissions()) {
+                missions.push_back(*mission);
+            }
+            sink = sink + missions.dump().size();
+        }));
+    }
+
+    if (want("savePlayer")) {
+        printResult("savePlayer", runBench(ops, [&](size_t i) {
+            server.savePlayer(names[i % saveSpan]);
+        }));
+        server.flushSaves();
+    }
+
+    // Round trip through the writer thread, for comparison with the queued cost
+    if (want("savePlayerAsync")) {
+        printResult("savePlayerAsync", runBench(ops, [&](size_t i) {
+            server.savePlayerAsync(names[i % saveSpan]).get();
+        }));
+    }
+
+    // One small change per save; with --store also reports the bytes each
+    // save appends, which stays flat with delta records
+    if (want("upgradeAndSave")) {
+        uintmax_t before = storeBytes();
+        printResult("upgradeAndSave", runBench(ops, [&](size_t i) {
+            server.upgradeSkill(names[i % saveSpan], skills[i % 4]);
+            server.savePlayerAsync(names[i % saveSpan]).get();
+        }));
+        if (packedStore) {
+            cout << "  store bytes/save " << (storeBytes() - before) / max(ops, (size_t)1) << endl;
+        }
+    }
+
+    if (want("loadPlayer")) {
+        printResult("loadPlayer", runBench(ops, [&](size_t i) {
+            server.loadPlayer(names[i % saveSpan]);
+        }));
+    }
+
+    if (want("Leaderboard::fetch")) {
+        Leaderboard board;
+        for (size_t i = 0; i < population; i++) {
+            board.update(names[i], 1 + (int)(i % 19), (int)((i * 2654435761u) % 1000000));
+        }
+        printResult("Leaderboard::fetch", runBench(ops, [&](size_t) {
+            board.fetch(10);
+        }));
+    }
+
+    size_t passes = min(ops, (size_t)10);
+    if (want("topBy")) {
+        printResult("topBy(credits, 10)", runBench(passes, [&](size_t) {
+            server.topBy(COLUMN_CREDITS, 10);
+        }));
+    }
+
+    if (want("decayHeat")) {
+        printResult("decayHeat", runBench(passes, [&](size_t) {
+            server.decayHeat(1);
+        }));
+    }
+
+    if (maxResident > 0) {
+        cout << "resident=" << server.residentPlayers() << " faults=" << server.playerFaults()
+             << " evictions=" << server.playerEvictions() << endl;
+    }
+
+    for (size_t i = 0; i < saveSpan; i++) {
+        remove((names[i] + ".sav").c_str());
+    }
+}
+
+// ============================================================================
+// MAIN FUNCTION
+// ============================================================================
+
+int main(int argc, char* argv[]) {
+    vector<size_t> sizes = {1000, 100000};
+    size_t ops = 100000;
+    string only;
+    uint64_t seed = 1;
+    bool columnar = false;
+    bool packedStore = false;
+    size_t maxResident = 0;
+    string dir = (filesystem::temp_directory_path() / "hacker_tycoon_bench").string();
+
+    // Logging is off by default so the numbers cover game logic only
+    gameLog().setLevel(LOG_OFF);
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--players" && i + 1 < argc) {
+            sizes = parseSizes(argv[++i]);
+        } else if (arg == "--ops" && i + 1 < argc) {
+            ops = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--only" && i + 1 < argc) {
+            only = argv[++i];
+        } else if (arg == "--columnar") {
+            columnar = true;
+        } else if (arg == "--store") {
+            packedStore = true;
+        } else if (arg == "--max-resident" && i + 1 < argc) {
+            maxResident = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--dir" && i + 1 < argc) {
+            dir = argv[++i];
+        } else if (arg == "--log-level" && i + 1 < argc) {
+            LogLevel level;
+            if (Logger::parseLevel(argv[++i], level)) {
+                gameLog().setLevel(level);
+            }
+        }
+    }
+
+    error_code ec;
+    filesystem::create_directories(dir, ec);
+    if (chdir(dir.c_str()) != 0) {
+        cout << "ERROR: Could not use scratch directory " << dir << endl;
+        return 1;
+    }
+
+    for (size_t population : sizes) {
+        runSuite(population, ops, only, seed, columnar, packedStore, maxResident);
+    }
+    return 0;
+}
@@ -0,0 +1,350 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <chrono>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+
+#include "gameserver.h"
+#include "gamejson.h"
+
+using namespace std;
+
+// ============================================================================
+// LINE READER
+// ============================================================================
+//
+// Yields input one line at a time. Interactive sessions read cin line by
+// line so each command runs as soon as it is typed; scripts are read in
+// large blocks and lines are handed out as views into the block, so a
+// replay of millions of commands never goes through iostream extraction.
+
+class LineReader {
+private:
+    static const size_t BLOCK_SIZE = 1 << 20;
+
+    FILE* file;                 // null reads cin
+    bool ownsFile;
+    vector<char> buffer;
+    size_t start;
+    size_t end;
+    bool eof;
+    string interactiveLine;
+
+    // Moves the unread tail to the front and appends the next block
+    bool fill() {
+        if (eof) return false;
+        if (start > 0) {
+            memmove(buffer.data(), buffer.data() + start, end - start);
+            end -= start;
+            start = 0;
+        }
+        if (end == buffer.size()) {
+            buffer.resize(buffer.size() * 2);
+        }
+        size_t got = fread(buffer.data() + end, 1, buffer.size() - end, file);
+        end += got;
+        if (got == 0) eof = true;
+        return got > 0;
+    }
+
+public:
+    LineReader() : file(nullptr), ownsFile(false), start(0), end(0), eof(false) {}
+
+    ~LineReader() {
+        if (ownsFile) fclose(file);
+    }
+
+    LineReader(const LineReader&) = delete;
+    LineReader& operator=(const LineReader&) = delete;
+
+    // Reads path ("-" for stdin) in blocks; false if it cannot be opened
+    bool openScript(const string& path) {
+        file = path == "-" ? stdin : fopen(path.c_str(), "rb");
+        if (!file) return false;
+        ownsFile = file != stdin;
+        buffer.resize(BLOCK_SIZE);
+        return true;
+    }
+
+    // Next line without its terminator; the view stays valid until the next
+    // call. Returns false at end of input.
+    bool next(string_view& line) {
+        if (!file) {
+            if (!getline(cin, interactiveLine)) return false;
+            line = interactiveLine;
+        } else {
+            while (true) {
+                const char* begin = buffer.data() + start;
+                const char* newline = (const char*)memchr(begin, '\n', end - start);
+                if (newline) {
+                    line = string_view(begin, newline - begin);
+                    start += line.size() + 1;
+                    break;
+                }
+                if (!fill()) {
+                    if (start == end) return false;
+                    line = string_view(buffer.data() + start, end - start);
+                    start = end;
+                    break;
+                }
+            }
+        }
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        return true;
+    }
+};
+
+// ============================================================================
+// CONSOLE
+// ============================================================================
+//
+// Command loop shared by the interactive REPL and --script replays. Results
+// are collected in an output buffer: interactive sessions flush it after
+// every command, scripts only when it fills up and at the end of the run.
+
+struct ConsoleStats {
+    unsigned long commands;
+    unsigned long errors;
+    double seconds;
+};
+
+class Console {
+private:
+    static const size_t MAX_TOKENS = 8;
+    static const size_t FLUSH_SIZE = 1 << 16;
+
+    GameServer& server;
+    LineReader& input;
+    bool interactive;
+    string out;
+    ConsoleStats stats;
+
+    void flush() {
+        fwrite(out.data(), 1, out.size(), stdout);
+        out.clear();
+        if (interactive) fflush(stdout);
+    }
+
+    void emit(const string& result) {
+        if (result.compare(0, 7, "ERROR: ") == 0) stats.errors++;
+        out += result;
+        out += '\n';
+    }
+
+    static size_t tokenize(string_view line, string_view* tokens) {
+        size_t count = 0;
+        size_t i = 0;
+        while (count < MAX_TOKENS) {
+            while (i < line.size() && (line[i] == ' ' || line[i] == '\t')) i++;
+            if (i == line.size()) break;
+            size_t begin = i;
+            while (i < line.size() && line[i] != ' ' && line[i] != '\t') i++;
+            tokens[count++] = line.substr(begin, i - begin);
+        }
+        return count;
+    }
+
+    static int toInt(string_view token, int fallback = 0) {
+        int value = fallback;
+        from_chars(token.data(), token.data() + token.size(), value);
+        return value;
+    }
+
+    static bool isBlank(string_view line) {
+        return line.find_first_not_of(" \t") == string_view::npos;
+    }
+
+    void runBatch() {
+        vector<BatchAction> actions;
+        string_view line;
+        while (input.next(line) && line != "end") {
+            if (isBlank(line)) continue;
+            BatchAction action;
+            if (!parseBatchAction(string(line), action)) {
+                emit("ERROR: Bad batch line: " + string(line));
+                continue;
+            }
+            actions.push_back(action);
+        }
+        vector<string> results = server.applyBatch(actions);
+        for (size_t i = 0; i < results.size(); i++) {
+            out += "[" + to_string(i + 1) + "] ";
+            emit(results[i]);
+        }
+    }
+
+    // Runs one command line; returns false when the session should end
+    bool execute(string_view line) {
+        string_view tokens[MAX_TOKENS];
+        size_t count = tokenize(line, tokens);
+        string_view command = tokens[0];
+        auto arg = [&](size_t i) { return string(i < count ? tokens[i] : string_view()); };
+
+        if (command == "create") {
+            emit(server.createPlayer(arg(1), arg(2)));
+        }
+        else if (command == "mission") {
+            emit(server.startMission(arg(1), toInt(arg(2)), toInt(arg(3))));
+        }
+        else if (command == "heat") {
+            emit(server.reduceHeat(arg(1)));
+        }
+        else if (command == "buy") {
+            emit(server.buyItem(arg(1), arg(2)));
+        }
+        else if (command == "upgrade") {
+            emit(server.upgradeSkill(arg(1), arg(2)));
+        }
+        else if (command == "story") {
+            emit(server.storyChoice(arg(1), arg(2)));
+        }
+        else if (command == "stats") {
+            if (server.renderPlayerStats(arg(1), out)) {
+                out += '\n';
+            } else {
+                emit("ERROR: Player not found");
+            }
+        }
+        else if (command == "export") {
+            Player player;
+            if (server.exportPlayer(arg(1), player)) {
+                out += json(player).dump(2);
+                out += '\n';
+            } else {
+                emit("ERROR: Player not found");
+            }
+        }
+        else if (command == "missions") {
+            string username = arg(1);
+            out += server.renderMissions(username == "all" ? "" : username);
+        }
+        else if (command == "save") {
+            emit(server.savePlayerAndWait(arg(1)));
+        }
+        else if (command == "load") {
+            emit(server.loadPlayer(arg(1)) ? "SUCCESS: Game loaded!" : "ERROR: Save file not found");
+        }
+        else if (command == "savepack") {
+            emit(server.savePack(arg(1)) ? "SUCCESS: Pack saved!" : "ERROR: Failed to save pack");
+        }
+        else if (command == "loadpack") {
+            long loaded = server.loadPack(arg(1));
+            if (loaded >= 0) {
+                emit("SUCCESS: Loaded " + to_string(loaded) + " players!");
+            } else {
+                emit("ERROR: Pack file not found or corrupt");
+            }
+        }
+        else if (command == "checkpoint") {
+            emit(server.checkpoint() ? "SUCCESS: Checkpoint written!" : "ERROR: Journal not enabled or checkpoint failed");
+        }
+        else if (command == "compact") {
+            int removed = server.compactStore();
+            if (removed >= 0) {
+                emit("SUCCESS: Compacted " + to_string(removed) + " segment(s)");
+            } else {
+                emit("ERROR: Save store not enabled or compaction failed");
+            }
+        }
+        else if (command == "log") {
+            string levelName = arg(1);
+            LogLevel level;
+            if (!Logger::parseLevel(levelName, level)) {
+                emit("ERROR: Unknown log level");
+                return true;
+            }
+            gameLog().setLevel(level);
+            if (count > 2) {
+                gameLog().setSampleEvery((uint32_t)toInt(tokens[2], 1));
+            }
+            emit("SUCCESS: Log level set to " + levelName);
+        }
+        else if (command == "leaderboard") {
+            int limit = count > 1 ? toInt(tokens[1]) : 0;
+            emit(server.renderLeaderboard(server.getLeaderboard(limit > 0 ? limit : 10)));
+        }
+        else if (command == "rank") {
+            int radius = count > 2 ? toInt(tokens[2]) : 0;
+            vector<LeaderboardEntry> entries = server.getLeaderboardAround(arg(1), radius > 0 ? radius : 2);
+            if (entries.empty()) {
+                emit("ERROR: Player not ranked");
+            } else {
+                emit(server.renderLeaderboard(entries));
+            }
+        }
+        else if (command == "top") {
+            string fieldName = arg(1);
+            ColumnField field;
+            if (!PlayerColumns::parseField(fieldName, field)) {
+                emit("ERROR: Unknown field " + fieldName);
+                return true;
+            }
+            int limit = count > 2 ? toInt(tokens[2]) : 0;
+            out += "\n=== TOP BY " + fieldName + " ===\n";
+            int position = 1;
+            for (const auto& entry : server.topBy(field, limit > 0 ? limit : 10)) {
+                out += "#" + to_string(position++) + " " + entry.first + " | " + to_string(entry.second) + "\n";
+            }
+        }
+        else if (command == "decay") {
+            int cooled = server.decayHeat(toInt(arg(1)));
+            emit(cooled < 0 ? "ERROR: Change could not be written to the journal"
+                            : "SUCCESS: Cooled " + to_string(cooled) + " player(s)");
+        }
+        else if (command == "batch") {
+            runBatch();
+        }
+        else if (command == "quit" || command == "exit") {
+            out += "Thanks for playing Hacker Tycoon!\n";
+            return false;
+        }
+        else {
+            emit("Unknown command. Type 'help' for commands.");
+        }
+        return true;
+    }
+
+public:
+    // interactive prompts for and flushes every command; otherwise output
+    // is buffered and no prompt is printed
+    Console(GameServer& server, LineReader& input, bool interactive)
+        : server(server), input(input), interactive(interactive), stats{0, 0, 0.0} {
+        out.reserve(FLUSH_SIZE * 2);
+    }
+
+    // Runs commands until quit or end of input
+    ConsoleStats run() {
+        auto started = chrono::steady_clock::now();
+        string_view line;
+        bool running = true;
+
+        while (running) {
+            if (interactive) {
+                out += "\n> ";
+                flush();
+            }
+
+            bool got = false;
+            while ((got = input.next(line)) && isBlank(line)) {}
+            if (!got) break;
+
+            stats.commands++;
+            running = execute(line);
+            if (interactive || out.size() >= FLUSH_SIZE) flush();
+        }
+        flush();
+
+        stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+        return stats;
+    }
+};
+
+#endif
@@ -1,29 +1,66 @@
-// API Base URL
+// API Base URL (the C++ server: hacker_tycoon --http)
 const API_URL = 'http://localhost:3002/api';
 
+// Playable characters; the server knows them by id and applies the bonuses
+const CHARACTERS = [
+    {
+        id: 'ghost',
+        name: 'Ghost',
+        avatar: '👻',
+        bonus: '+2 Hacking, -10 heat on every mission',
+        backstory: 'Once a cybersecurity expert for a major corporation, you witnessed corruption at the highest levels. Now you use your skills to expose the truth and fight for justice in the digital underground.'
+    },
+    {
+        id: 'cipher',
+        name: 'Cipher',
+        avatar: '🎭',
+        bonus: '+2 Cryptography, +15% XP',
+        backstory: 'A cryptography genius and social engineer. You can crack any code and manipulate anyone. Your mysterious past is encrypted even from yourself.'
+    },
+    {
+        id: 'rebel',
+        name: 'Rebel',
+        avatar: '🔥',
+        bonus: '+2 Networking, starts with 50 reputation',
+        backstory: 'A reformed black hat hacker who got caught and served time. You emerged with a new purpose: to use your notorious skills for good while staying one step ahead of your past.'
+    },
+    {
+        id: 'architect',
+        name: 'Architect',
+        avatar: '⚡',
+        bonus: '+2 Programming, starts with 100 credits',
+        backstory: 'Born into the digital age, you learned to code before you could write. A prodigy with bleeding-edge tech knowledge and unlimited potential.'
+    }
+];
+
+// Story paths a player can commit to after the intro; each opens its own missions
+const STORY_PATHS = [
+    { id: 'stealth', name: 'Shadow Operative', text: 'Stay invisible. Slip in, take what you need, leave no trace.' },
+    { id: 'aggressive', name: 'Digital Warlord', text: 'Hit hard and hit loud. Let them know who took them down.' },
+    { id: 'neutral', name: 'Calculated Strategist', text: 'Pick every fight carefully and never show your whole hand.' }
+];
+
+const SKILLS = ['hacking', 'cryptography', 'networking', 'programming'];
+
 // Game Class
 class Game {
     constructor() {
         this.player = null;
-        this.gameState = null;
-        this.playerId = this.generatePlayerId();
-        this.characters = [];
+        this.playerId = localStorage.getItem('hackerTycoonPlayerId');
         this.missions = [];
         this.shopItems = [];
         this.achievements = [];
         this.currentMiniGame = null;
         this.currentMission = null;
-        
+
         this.init();
-        
+
     }
 
+    // Every new game is a new server-side player
     generatePlayerId() {
-        let id = localStorage.getItem('hackerTycoonPlayerId');
-        if (!id) {
-            id = 'player_' + Date.now() + '_' + Math.random().toString(36).substr(2, 9);
-            localStorage.setItem('hackerTycoonPlayerId', id);
-        }
+        const id = 'player_' + Date.now() + '_' + Math.random().toString(36).substr(2, 9);
+        localStorage.setItem('hackerTycoonPlayerId', id);
         return id;
     }
 
@@ -31,184 +68,114 @@ class Game {
         await this.loadStaticData();
     }
 
+    // Calls the API; resolves to { ok, data } where data is the JSON body
+    // ({status, message} for actions)
+    async api(path, method = 'GET', body = null) {
+        const options = { method };
+        if (body) {
+            options.headers = { 'Content-Type': 'application/json' };
+            options.body = JSON.stringify(body);
+        }
+        const response = await fetch(`${API_URL}${path}`, options);
+        const data = await response.json();
+        return { ok: response.ok && data.status !== 'error', data };
+    }
+
+    playerPath(action = '') {
+        return `/players/${encodeURIComponent(this.playerId)}${action}`;
+    }
+
     async loadStaticData() {
         try {
-            const [charactersRes, shopRes, achievementsRes] = await Promise.all([
-                fetch(`${API_URL}/characters`),
-                fetch(`${API_URL}/shop`),
-                fetch(`${API_URL}/achievements`)
+            const [shop, achievements] = await Promise.all([
+                this.api('/shop'),
+                this.api('/achievements')
             ]);
 
-            this.characters = await charactersRes.json();
-            this.shopItems = await shopRes.json();
-            this.achievements = await achievementsRes.json();
+            this.shopItems = shop.data.items;
+            this.achievements = achievements.data.achievements;
         } catch (error) {
             console.error('Error loading data:', error);
             this.showNotification('Error connecting to server');
         }
     }
 
-    // STORY METHODS
-    async loadStoryNode(nodeId) {
-        try {
-            const response = await fetch(`${API_URL}/story/${nodeId}`);
-            if (!response.ok) {
-                throw new Error('Story node not found');
-            }
-            return await response.json();
-        } catch (error) {
-            console.error('Error loading story node:', error);
-            return null;
+    async refreshPlayer() {
+        const { ok, data } = await this.api(this.playerPath('?format=json'));
+        if (!ok) {
+            throw new Error(data.message);
         }
+        this.player = data.player;
+        this.character = CHARACTERS.find(c => c.id === this.player.character) || CHARACTERS[0];
     }
 
-    async makeStoryChoice(choiceIndex) {
-        try {
-            const response = await fetch(`${API_URL}/story/choice`, {
-                method: 'POST',
-                headers: { 'Content-Type': 'application/json' },
-                body: JSON.stringify({
-                    playerId: this.playerId,
-                    currentNode: this.player.currentStoryNode || 'intro',
-                    choiceIndex
-                })
-            });
-
-            if (!response.ok) {
-                const error = await response.json();
-                this.showNotification(error.error || 'Cannot make this choice yet');
-                return;
-            }
-
-            const data = await response.json();
-            this.player = data.player;
-
-            if (data.isEnding) {
-                this.showStoryEnding(data.nextNode);
-            } else {
-                this.showStoryNode(data.nextNode);
-            }
-        } catch (error) {
-            console.error('Error making story choice:', error);
-            this.showNotification('Error making choice');
-        }
-    }
-
-    showStoryNode(node) {
+    // STORY METHODS
+    showPathChoice() {
         const modal = document.getElementById('minigame-modal');
         const content = document.getElementById('minigame-content');
-        
+
         content.innerHTML = `
             <div class="story-node">
-                <h2 style="color: #00ff00; margin-bottom: 1rem;">${node.title}</h2>
+                <h2 style="color: #00ff00; margin-bottom: 1rem;">Choose Your Path</h2>
                 <p style="line-height: 1.8; margin-bottom: 2rem; color: #00dd00;">
-                    ${node.text}
+                    Word of your skills is spreading through the underground. How you work from here decides which jobs come your way.
                 </p>
-                <div class="story-choices" id="story-choices-container">
-                    ${node.choices.map((choice, index) => {
-                        let disabled = false;
-                        let reqText = '';
-                        
-                        if (choice.requirement) {
-                            const req = choice.requirement;
-                            if (req.type === 'level') {
-                                disabled = this.player.level < req.value;
-                                reqText = `Requires Level ${req.value}`;
-                            } else if (req.type === 'money') {
-                                disabled = this.player.money < req.value;
-                                reqText = `Requires $${req.value}`;
-                            } else if (req.type === 'heat') {
-                                disabled = this.player.heat > req.max;
-                                reqText = `Requires Heat below ${req.max}`;
-                            } else if (req.type === 'skill') {
-                                disabled = this.player.skills[req.skill] < req.value;
-                                reqText = `Requires ${req.skill} ${req.value}`;
-                            } else if (req.type === 'missions') {
-                                const count = this.player.path.filter(p => p === req.missionType).length;
-                                disabled = count < req.count;
-                                reqText = `Requires ${req.count} ${req.missionType} missions`;
-                            }
-                        }
-                        
-                        return `
-                            <button 
-                                class="btn btn-secondary story-choice-btn" 
-                                data-choice-index="${index}"
-                                ${disabled ? 'disabled' : ''}
-                                style="margin-bottom: 1rem; text-align: left; padding: 1rem;"
-                            >
-                                <div>${choice.text}</div>
-                                ${reqText ? `<div style="font-size: 0.8rem; color: #ff6600; margin-top: 0.5rem;">${reqText}</div>` : ''}
-                            </button>
-                        `;
-                    }).join('')}
+                <div class="story-choices">
+                    ${STORY_PATHS.map(path => `
+                        <button
+                            class="btn btn-secondary story-choice-btn"
+                            data-path="${path.id}"
+                            style="margin-bottom: 1rem; text-align: left; padding: 1rem;"
+                        >
+                            <div>${path.name}</div>
+                            <div style="font-size: 0.8rem; color: #ff6600; margin-top: 0.5rem;">${path.text}</div>
+                        </button>
+                    `).join('')}
                 </div>
-                ${!node.ending ? '<button class="btn btn-small" id="close-story-btn" style="margin-top: 1rem; background: #333;">Close</button>' : ''}
+                <button class="btn btn-small" id="close-story-btn" style="margin-top: 1rem; background: #333;">Close</button>
             </div>
         `;
-        
+
         modal.classList.add('active');
-        
-        // Add event listeners to choice buttons
-        setTimeout(() => {
-            document.querySelectorAll('.story-choice-btn').forEach(btn => {
-                btn.addEventListener('click', () => {
-                    const choiceIndex = parseInt(btn.dataset.choiceIndex);
-                    this.makeStoryChoice(choiceIndex);
-                });
-            });
 
-            const closeBtn = document.getElementById('close-story-btn');
-            if (closeBtn) {
-                closeBtn.addEventListener('click', () => {
-                    this.closeStoryModal();
-                });
-            }
-        }, 100);
+        document.querySelectorAll('.story-choice-btn').forEach(btn => {
+            btn.addEventListener('click', () => this.makeStoryChoice(btn.dataset.path));
+        });
+        document.getElementById('close-story-btn').addEventListener('click', () => this.closeStoryModal());
     }
 
-    showStoryEnding(node) {
-        const modal = document.getElementById('minigame-modal');
+    showCurrentPath() {
+        const path = STORY_PATHS.find(p => p.id === this.player.storyPath);
         const content = document.getElementById('minigame-content');
-        
-        const endingColor = node.endingType === 'good' ? '#00ff00' : 
-                            node.endingType === 'bad' ? '#ff0000' : '#ffaa00';
-        
+
         content.innerHTML = `
-            <div class="story-ending" style="text-align: center;">
-                <div style="font-size: 4rem; margin-bottom: 1rem;">
-                    ${node.endingType === 'good' ? '🏆' : node.endingType === 'bad' ? '💀' : '⚖️'}
-                </div>
-                <h2 style="color: ${endingColor}; margin-bottom: 1rem; font-size: 2rem;">
-                    ${node.title}
-                </h2>
-                <p style="line-height: 1.8; margin-bottom: 2rem; color: #00dd00; font-size: 1.1rem;">
-                    ${node.text}
+            <div class="story-node">
+                <h2 style="color: #00ff00; margin-bottom: 1rem;">${path ? path.name : this.player.storyPath}</h2>
+                <p style="line-height: 1.8; margin-bottom: 2rem; color: #00dd00;">
+                    ${path ? path.text : ''}
                 </p>
-                <div style="background: #1a1a1a; padding: 1.5rem; border-radius: 5px; border: 2px solid ${endingColor}; margin-bottom: 2rem;">
-                    <h3 style="margin-bottom: 1rem;">Your Journey:</h3>
-                    <p>Level: ${this.player.level}</p>
-                    <p>Money: $${this.player.money}</p>
-                    <p>Missions: ${this.player.missionsCompleted}</p>
-                    <p>Achievements: ${this.player.achievements.length}</p>
-                </div>
-                <button 
-                    class="btn btn-primary" 
-                    id="ending-menu-btn"
-                >
-                    RETURN TO MENU
-                </button>
+                <button class="btn btn-small" id="close-story-btn" style="margin-top: 1rem; background: #333;">Close</button>
             </div>
         `;
-        
-        modal.classList.add('active');
 
-        setTimeout(() => {
-            document.getElementById('ending-menu-btn').addEventListener('click', () => {
-                this.closeStoryModal();
-                this.showScreen('menu');
-            });
-        }, 100);
+        document.getElementById('minigame-modal').classList.add('active');
+        document.getElementById('close-story-btn').addEventListener('click', () => this.closeStoryModal());
+    }
+
+    async makeStoryChoice(path) {
+        try {
+            const { ok, data } = await this.api(this.playerPath('/story'), 'POST', { path });
+            this.closeStoryModal();
+            this.showNotification(data.message);
+            if (ok) {
+                await this.refreshPlayer();
+                await this.loadMissions();
+                this.renderGame();
+            }
+        } catch (error) {
+            console.error('Error making story choice:', error);
+            this.showNotification('Error making choice');
+        }
     }
 
     closeStoryModal() {
@@ -216,16 +183,22 @@ class Game {
         modal.classList.remove('active');
     }
 
-    async checkStoryProgress() {
-        if (!this.player.currentStoryNode) {
-            this.player.currentStoryNode = 'intro';
+    checkStoryProgress() {
+        if (this.player.storyPath === 'intro') {
+            this.showPathChoice();
         }
-        
-        if (!this.player.storyPath || this.player.storyPath.length === 0) {
-            const node = await this.loadStoryNode('intro');
-            if (node) {
-                this.showStoryNode(node);
-            }
+    }
+
+    viewStory() {
+        if (!this.player) {
+            this.showNotification('No active game');
+            return;
+        }
+
+        if (this.player.storyPath === 'intro') {
+            this.showPathChoice();
+        } else {
+            this.showCurrentPath();
         }
     }
 
@@ -245,52 +218,28 @@ class Game {
 
     renderCharacters() {
         const grid = document.getElementById('character-grid');
-        grid.innerHTML = this.characters.map(char => `
+        grid.innerHTML = CHARACTERS.map(char => `
             <div class="character-card" onclick="game.selectCharacter('${char.id}')">
                 <div class="character-avatar">${char.avatar}</div>
                 <div class="character-name">${char.name}</div>
-                <div class="character-skills">
-                    <div class="skill-row">
-                        <span>Hacking:</span>
-                        <span class="skill-bar">${'█'.repeat(char.skills.hacking)}</span>
-                    </div>
-                    <div class="skill-row">
-                        <span>Stealth:</span>
-                        <span class="skill-bar">${'█'.repeat(char.skills.stealth)}</span>
-                    </div>
-                    <div class="skill-row">
-                        <span>Social:</span>
-                        <span class="skill-bar">${'█'.repeat(char.skills.social)}</span>
-                    </div>
-                    <div class="skill-row">
-                        <span>Tech:</span>
-                        <span class="skill-bar">${'█'.repeat(char.skills.tech)}</span>
-                    </div>
-                </div>
+                <div class="character-skills">${char.bonus}</div>
             </div>
         `).join('');
     }
 
     async selectCharacter(characterId) {
         try {
-            const response = await fetch(`${API_URL}/game/new`, {
-                method: 'POST',
-                headers: { 'Content-Type': 'application/json' },
-                body: JSON.stringify({ characterId, playerId: this.playerId })
+            this.playerId = this.generatePlayerId();
+            const { ok, data } = await this.api('/players', 'POST', {
+                username: this.playerId,
+                character: characterId
             });
-
-            const data = await response.json();
-            this.player = data.player;
-            this.gameState = data.gameState;
-            
-            // Initialize story state
-            if (!this.player.currentStoryNode) {
-                this.player.currentStoryNode = 'intro';
-            }
-            if (!this.player.storyPath) {
-                this.player.storyPath = [];
+            if (!ok) {
+                this.showNotification(data.message);
+                return;
             }
 
+            await this.refreshPlayer();
             this.showBackstory();
         } catch (error) {
             console.error('Error creating game:', error);
@@ -301,10 +250,10 @@ class Game {
     showBackstory() {
         const content = document.getElementById('backstory-content');
         content.innerHTML = `
-            <div class="character-avatar">${this.player.avatar}</div>
-            <h2>${this.player.name}</h2>
+            <div class="character-avatar">${this.character.avatar}</div>
+            <h2>${this.character.name}</h2>
             <div class="panel" style="max-width: 600px;">
-                <p style="line-height: 1.8; font-size: 1.1rem;">${this.player.backstory}</p>
+                <p style="line-height: 1.8; font-size: 1.1rem;">${this.character.backstory}</p>
             </div>
             <button class="btn btn-primary" onclick="game.startGame()">BEGIN JOURNEY</button>
         `;
@@ -314,15 +263,15 @@ class Game {
     async startGame() {
         await this.loadMissions();
         this.showScreen('game');
-        
-        // Show initial story if it's a new game
+
+        // Offer the story paths if it's a new game
         setTimeout(() => this.checkStoryProgress(), 1000);
     }
 
     async loadMissions() {
         try {
-            const response = await fetch(`${API_URL}/missions?level=${this.player.level}`);
-            this.missions = await response.json();
+            const { data } = await this.api(`/missions?player=${encodeURIComponent(this.playerId)}`);
+            this.missions = data.missions;
         } catch (error) {
             console.error('Error loading missions:', error);
         }
@@ -340,22 +289,20 @@ class Game {
         stats.innerHTML = `
             <div class="stats-header">
                 <div class="player-info">
-                    <div class="player-avatar">${this.player.avatar}</div>
+                    <div class="player-avatar">${this.character.avatar}</div>
                     <div class="player-details">
-                        <h3>${this.player.name}</h3>
-                        <p>Level ${this.player.level} | XP: ${this.player.xp}/100</p>
+                        <h3>${this.character.name}</h3>
+                        <p>Level ${this.player.level} | XP: ${this.player.xp}/${this.player.xpToLevel}</p>
                     </div>
                 </div>
                 <div class="stats-grid">
                     <div class="stat-item">
-                        <div class="stat-label">Money</div>
-                        <div class="stat-value">$${this.player.money}</div>
+                        <div class="stat-label">Credits</div>
+                        <div class="stat-value">${this.player.credits} ¢</div>
                     </div>
                     <div class="stat-item">
-                        <div class="stat-label">Energy</div>
-                        <div class="stat-value ${this.player.energy < 30 ? 'danger' : ''}">
-                            ${this.player.energy}/100
-                        </div>
+                        <div class="stat-label">Reputation</div>
+                        <div class="stat-value">${this.player.reputation}</div>
                     </div>
                     <div class="stat-item">
                         <div class="stat-label">Heat</div>
@@ -366,113 +313,94 @@ class Game {
                 </div>
             </div>
             <div class="skills-row">
-                <div>Hacking: ${this.player.skills.hacking}</div>
-                <div>Stealth: ${this.player.skills.stealth}</div>
-                <div>Social: ${this.player.skills.social}</div>
-                <div>Tech: ${this.player.skills.tech}</div>
+                ${SKILLS.map(skill => `
+                    <div>
+                        ${skill[0].toUpperCase() + skill.slice(1)}: ${this.player.skills[skill]}
+                        <button
+                            class="btn btn-small"
+                            onclick="game.upgradeSkill('${skill}')"
+                            ${this.player.credits < this.player.skills[skill] * 500 ? 'disabled' : ''}
+                        >
+                            +1 (${this.player.skills[skill] * 500} ¢)
+                        </button>
+                    </div>
+                `).join('')}
             </div>
         `;
     }
 
     renderMissions() {
-    const list = document.getElementById('missions-list');
-    list.innerHTML = this.missions.map(mission => `
-        <div class="mission-card ${mission.type}">
-            <div class="mission-header">
-                <div>
-                    <div class="mission-title">${mission.name}</div>
-                    <div class="mission-story">${mission.story}</div>
+        const list = document.getElementById('missions-list');
+        list.innerHTML = this.missions.map(mission => `
+            <div class="mission-card ${mission.type}">
+                <div class="mission-header">
+                    <div>
+                        <div class="mission-title">${mission.name}</div>
+                        <div class="mission-story">Requires level ${mission.reqLevel}</div>
+                    </div>
+                    <span class="mission-badge ${mission.type}">${mission.type.toUpperCase()}</span>
                 </div>
-                <span class="mission-badge ${mission.type}">${mission.type.toUpperCase()}</span>
-            </div>
-            <div class="mission-details">
-                <span>💰 $${mission.money} | ⚡ ${mission.xp}XP</span>
-                <span>⚠️ ${mission.energy} Energy | 🔥 +${mission.heat} Heat</span>
+                <div class="mission-details">
+                    <span>💰 ${mission.creditsReward} ¢ | ⚡ ${mission.xpReward}XP</span>
+                    <span>🔥 +${mission.heat} Heat</span>
+                </div>
+                <button
+                    class="btn btn-small"
+                    onclick="game.startMission(${mission.id})"
+                    ${mission.done || mission.locked ? 'disabled' : ''}
+                >
+                    ${mission.done ? 'DONE' : mission.locked ? 'LOCKED' : 'START MISSION'}
+                </button>
             </div>
-            <button 
-                class="btn btn-small" 
-                onclick="game.startMission(${mission.id})"
-                ${this.player.energy < mission.energy ? 'disabled' : ''}
+        `).join('') + `
+            <button
+                class="btn btn-small"
+                style="margin-top: 1rem;"
+                onclick="game.viewStory()"
             >
-                START MISSION
+                📖 VIEW STORY
             </button>
-        </div>
-    `).join('') + `
-        <button 
-            class="btn btn-small" 
-            style="margin-top: 1rem;"
-            onclick="game.viewStory()"
-        >
-            📖 VIEW STORY
-        </button>
-        <button 
-            class="btn btn-small" 
-            onclick="game.rest()"
-        >
-            😴 REST (+30 Energy, -5 Heat)
-        </button>
-        <button 
-            class="btn btn-small" 
-            onclick="game.saveGame()"
-        >
-            💾 SAVE GAME
-        </button>
-    `;
-    }
-async viewStory() {
-    console.log('viewStory called');
-    if (!this.player) {
-        this.showNotification('No active game');
-        return;
-    }
-    
-    const nodeId = this.player.currentStoryNode || 'intro';
-    console.log('Loading story node:', nodeId);
-    
-    try {
-        const response = await fetch(`${API_URL}/story/${nodeId}`);
-        if (!response.ok) {
-            throw new Error('Failed to load story');
-        }
-        
-        const node = await response.json();
-        console.log('Story node loaded:', node);
-        this.showStoryNode(node);
-    } catch (error) {
-        console.error('Error:', error);
-        this.showNotification('Error loading story');
+        `;
     }
-}
+
     renderShop() {
         const list = document.getElementById('shop-list');
-        list.innerHTML = this.shopItems.map(item => `
-            <div class="shop-item">
-                <div class="shop-item-name">${item.name}</div>
-                <div class="shop-item-desc">${item.desc}</div>
-                <div class="shop-item-footer">
-                    <span class="shop-item-price">$${item.cost}</span>
-                    <button 
-                        class="btn btn-small" 
-                        onclick="game.buyItem('${item.id}')"
-                        ${this.player.inventory.includes(item.id) || this.player.money < item.cost ? 'disabled' : ''}
-                    >
-                        ${this.player.inventory.includes(item.id) ? 'OWNED' : 'BUY'}
-                    </button>
+        list.innerHTML = this.shopItems.map(item => {
+            const owned = this.player.equipment.includes(item.id);
+            const perks = [
+                item.successBonus ? `+${item.successBonus}% success` : '',
+                item.xpBonus ? `+${item.xpBonus}% XP` : '',
+                item.heatReduction ? `-${item.heatReduction} heat` : ''
+            ].filter(Boolean).join(', ');
+            return `
+                <div class="shop-item">
+                    <div class="shop-item-name">${item.name}</div>
+                    <div class="shop-item-desc">${perks}</div>
+                    <div class="shop-item-footer">
+                        <span class="shop-item-price">${item.price} ¢</span>
+                        <button
+                            class="btn btn-small"
+                            onclick="game.buyItem('${item.id}')"
+                            ${owned || this.player.credits < item.price ? 'disabled' : ''}
+                        >
+                            ${owned ? 'OWNED' : 'BUY'}
+                        </button>
+                    </div>
                 </div>
-            </div>
-        `).join('');
+            `;
+        }).join('');
     }
 
     renderAchievements() {
         const list = document.getElementById('achievements-list');
         list.innerHTML = this.achievements.map(ach => {
-            const unlocked = this.player.achievements.includes(ach.id);
+            const unlocked = this.player.unlocked.includes(ach.id);
             return `
                 <div class="achievement-item ${unlocked ? 'unlocked' : 'locked'}">
-                    <div class="achievement-icon-small">${unlocked ? '✓' : '🔒'}</div>
+                    <div class="achievement-icon-small">${unlocked ? ach.icon : '🔒'}</div>
                     <div class="achievement-details">
                         <div class="achievement-name">${ach.name}</div>
-                        <div class="achievement-desc">${ach.desc}</div>
+                        <div class="achievement-desc">${ach.description}</div>
                     </div>
                 </div>
             `;
@@ -637,50 +565,26 @@ async viewStory() {
         });
     }
 
+    // Chance the server rolls against; it adds the equipment's success bonus
+    successRate(miniGameSuccess) {
+        return miniGameSuccess ? 70 : 35;
+    }
+
     async completeMiniGame(success) {
         document.getElementById('minigame-modal').classList.remove('active');
 
         try {
-            const response = await fetch(`${API_URL}/mission/complete`, {
-                method: 'POST',
-                headers: { 'Content-Type': 'application/json' },
-                body: JSON.stringify({
-                    playerId: this.playerId,
-                    missionId: this.currentMission.id,
-                    success,
-                    miniGameSuccess: success
-                })
+            const { data } = await this.api(this.playerPath('/mission'), 'POST', {
+                missionId: this.currentMission.id,
+                successRate: this.successRate(success)
             });
+            this.showNotification(data.message);
 
-            const result = await response.json();
-            this.player = result.player;
-
-            if (result.succeeded) {
-                this.showNotification(
-                    `Mission Success! +$${result.rewards.money} +${result.rewards.xp}XP`
-                );
-                
-                if (result.levelUp) {
-                    setTimeout(() => {
-                        this.showNotification(`Level Up! Now level ${result.newLevel}`);
-                    }, 1500);
-                }
-
-                if (result.newAchievement) {
-                    setTimeout(() => {
-                        this.showNotification(`Achievement: ${result.newAchievement.name}!`);
-                        
-                        if (result.newAchievement.id === 'master') {
-                            setTimeout(() => this.showVictory(), 2000);
-                        }
-                    }, 2000);
-                }
-            } else {
-                this.showNotification('Mission Failed!');
-            }
-
-            if (result.gameOver) {
+            await this.refreshPlayer();
+            if (this.player.gameLost) {
                 setTimeout(() => this.showGameOver(), 2000);
+            } else if (this.player.gameWon) {
+                setTimeout(() => this.showVictory(), 2000);
             } else {
                 await this.loadMissions();
                 this.renderGame();
@@ -691,62 +595,39 @@ async viewStory() {
         }
     }
 
-    async buyItem(itemId) {
+    // Shared by the purchase, upgrade and heat actions: show the server's
+    // message and redraw
+    async playerAction(action, body, failure) {
         try {
-            const response = await fetch(`${API_URL}/shop/buy`, {
-                method: 'POST',
-                headers: { 'Content-Type': 'application/json' },
-                body: JSON.stringify({
-                    playerId: this.playerId,
-                    itemId
-                })
-            });
-
-            if (!response.ok) {
-                const error = await response.json();
-                this.showNotification(error.error);
-                return;
+            const { ok, data } = await this.api(this.playerPath(action), 'POST', body);
+            this.showNotification(data.message);
+            if (ok) {
+                await this.refreshPlayer();
+                this.renderGame();
             }
-
-            const data = await response.json();
-            this.player = data.player;
-            this.showNotification(`Purchased ${data.item.name}!`);
-            this.renderGame();
         } catch (error) {
-            console.error('Error buying item:', error);
-            this.showNotification('Error buying item');
+            console.error(`${failure}:`, error);
+            this.showNotification(failure);
         }
     }
 
-    async rest() {
-        try {
-            const response = await fetch(`${API_URL}/game/rest`, {
-                method: 'POST',
-                headers: { 'Content-Type': 'application/json' },
-                body: JSON.stringify({ playerId: this.playerId })
-            });
+    buyItem(itemId) {
+        return this.playerAction('/buy', { itemId }, 'Error buying item');
+    }
 
-            const data = await response.json();
-            this.player = data.player;
-            this.showNotification('Rested: +30 Energy, -5 Heat');
-            this.renderGame();
-        } catch (error) {
-            console.error('Error resting:', error);
-        }
+    upgradeSkill(skill) {
+        return this.playerAction('/upgrade', { skill }, 'Error upgrading skill');
+    }
+
+    // Lay low: 300 credits for -20 heat
+    rest() {
+        return this.playerAction('/heat', null, 'Error reducing heat');
     }
 
     async saveGame() {
         try {
-            await fetch(`${API_URL}/game/save`, {
-                method: 'POST',
-                headers: { 'Content-Type': 'application/json' },
-                body: JSON.stringify({
-                    playerId: this.playerId,
-                    player: this.player,
-                    gameState: this.gameState
-                })
-            });
-            this.showNotification('Game Saved!');
+            const { data } = await this.api(this.playerPath('/save'), 'POST');
+            this.showNotification(data.message);
         } catch (error) {
             console.error('Error saving game:', error);
             this.showNotification('Error saving game');
@@ -754,29 +635,24 @@ async viewStory() {
     }
 
     async loadGame() {
+        if (!this.playerId) {
+            this.showNotification('No saved game found!');
+            return;
+        }
+
         try {
-            const response = await fetch(`${API_URL}/game/load/${this.playerId}`);
-            
-            if (!response.ok) {
+            // A player still in the server's memory can carry on unsaved
+            const { ok } = await this.api(this.playerPath('/load'), 'POST');
+            try {
+                await this.refreshPlayer();
+            } catch (error) {
                 this.showNotification('No saved game found!');
                 return;
             }
 
-            const data = await response.json();
-            this.player = data.player;
-            this.gameState = data.gameState;
-            
-            // Initialize story state if missing
-            if (!this.player.currentStoryNode) {
-                this.player.currentStoryNode = 'intro';
-            }
-            if (!this.player.storyPath) {
-                this.player.storyPath = [];
-            }
-            
             await this.loadMissions();
             this.showScreen('game');
-            this.showNotification('Game Loaded!');
+            this.showNotification(ok ? 'Game Loaded!' : 'Resumed unsaved game');
         } catch (error) {
             console.error('Error loading game:', error);
             this.showNotification('Error loading game');
@@ -785,20 +661,20 @@ async viewStory() {
 
     async loadLeaderboard() {
         try {
-            const response = await fetch(`${API_URL}/leaderboard`);
-            const leaderboard = await response.json();
+            const { data } = await this.api('/leaderboard');
+            const leaderboard = data.entries;
 
             const content = document.getElementById('leaderboard-content');
             if (leaderboard.length === 0) {
                 content.innerHTML = '<p style="text-align: center;">No players yet!</p>';
             } else {
-                content.innerHTML = leaderboard.map((player, index) => `
+                content.innerHTML = leaderboard.map(player => `
                     <div class="leaderboard-item">
-                        <div class="leaderboard-rank">${index + 1}</div>
+                        <div class="leaderboard-rank">${player.rank}</div>
                         <div class="leaderboard-info">
-                            <div class="leaderboard-name">${player.name}</div>
+                            <div class="leaderboard-name">${player.username}</div>
                             <div class="leaderboard-stats">
-                                Level ${player.level} | $${player.money} | ${player.missionsCompleted} missions
+                                Level ${player.level} | ${player.credits} ¢
                             </div>
                         </div>
                     </div>
@@ -815,9 +691,9 @@ async viewStory() {
             <div class="panel" style="margin: 2rem 0;">
                 <p style="font-size: 1.2rem; margin-bottom: 1rem;">Final Stats:</p>
                 <p>Level: ${this.player.level}</p>
-                <p>Money: $${this.player.money}</p>
+                <p>Credits: ${this.player.credits} ¢</p>
                 <p>Missions Completed: ${this.player.missionsCompleted}</p>
-                <p>Achievements: ${this.player.achievements.length}/${this.achievements.length}</p>
+                <p>Achievements: ${this.player.achievements}/${this.player.achievementsTotal}</p>
             </div>
         `;
         this.showScreen('victory');
@@ -828,25 +704,27 @@ async viewStory() {
         stats.innerHTML = `
             <div class="panel" style="margin: 2rem 0;">
                 <p style="font-size: 1.2rem; margin-bottom: 1rem;">You reached:</p>
-<p>Level: ${this.player.level}</p>
-<p>Money: $${this.player.money}</p>
-<p>Missions Completed: ${this.player.missionsCompleted}</p>
-</div>
-`;
-this.showScreen('gameover');
+                <p>Level: ${this.player.level}</p>
+                <p>Credits: ${this.player.credits} ¢</p>
+                <p>Missions Completed: ${this.player.missionsCompleted}</p>
+            </div>
+        `;
+        this.showScreen('gameover');
     }
+
     showNotification(message) {
-    const notification = document.getElementById('notification');
-    notification.textContent = message;
-    notification.classList.add('active');
+        const notification = document.getElementById('notification');
+        notification.textContent = message;
+        notification.classList.add('active');
 
-    setTimeout(() => {
-        notification.classList.remove('active');
-    }, 3000);
-}
+        setTimeout(() => {
+            notification.classList.remove('active');
+        }, 3000);
+    }
 }
+
 // Initialize game when page loads
 let game;
 document.addEventListener('DOMContentLoaded', () => {
-game = new Game();
+    game = new Game();
 });
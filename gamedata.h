@@ -0,0 +1,385 @@
+#ifndef GAMEDATA_H
+#define GAMEDATA_H
+
+#include <string>
+#include <vector>
+#include <array>
+#include <ctime>
+#include <bitset>
+#include <climits>
+#include <cctype>
+#include <algorithm>
+
+#include "symbols.h"
+
+using namespace std;
+
+// ============================================================================
+// STRUCTURES
+// ============================================================================
+
+// Fixed capacities for the per-player completion bitsets
+const int MAX_MISSION_ID = 64;   // mission ids must stay below this
+const int MAX_ACHIEVEMENTS = 32;
+const int DEFAULT_INVENTORY_CAP = 99;  // most of one loot item a player can hold
+const int MAX_LEVEL = 100;             // bounds for imported players
+const int MAX_SKILL_LEVEL = 100;
+const size_t MAX_USERNAME_LENGTH = 32;
+
+// Interned names the rules compare against
+inline const Symbol SYM_ALL = intern("all");
+inline const Symbol SYM_INTRO = intern("intro");
+inline const Symbol SYM_STEALTH = intern("stealth");
+inline const Symbol SYM_AGGRESSIVE = intern("aggressive");
+inline const Symbol SYM_GHOST = intern("ghost");
+inline const Symbol SYM_CIPHER = intern("cipher");
+inline const Symbol SYM_REBEL = intern("rebel");
+inline const Symbol SYM_ARCHITECT = intern("architect");
+inline const Symbol EFFECT_CREDITS = intern("credits");
+inline const Symbol EFFECT_HEAT = intern("heat");
+inline const Symbol EFFECT_DOUBLE_REWARD = intern("doubleReward");
+inline const Symbol EFFECT_XP_BONUS = intern("xpBonus");
+inline const Symbol EFFECT_REPUTATION = intern("reputation");
+
+// Loot a successful mission can drop
+inline const Symbol LOOT_ITEMS[] = {intern("VPN Key"), intern("Exploit Kit"), intern("Crypto Wallet"),
+                                    intern("Firewall Bypass"), intern("Root Token")};
+const int LOOT_ITEM_COUNT = 5;
+
+struct Mission {
+    int id;
+    string name;
+    int difficulty;
+    int xpReward;
+    int creditsReward;
+    int reqLevel;
+    string type; // "legal" or "illegal"
+    int heat;
+    vector<Symbol> paths;
+    
+    Mission(int i, string n, int d, int xp, int cr, int rl, string t, int h, vector<string> p)
+        : id(i), name(n), difficulty(d), xpReward(xp), creditsReward(cr), 
+          reqLevel(rl), type(t), heat(h) {
+        for (const auto& path : p) {
+            paths.push_back(intern(path));
+        }
+    }
+};
+
+struct ShopItem {
+    Symbol id;
+    string name;
+    int price;
+    int successBonus;
+    int xpBonus;
+    int heatReduction;
+    string type;
+    
+    ShopItem(string i, string n, int p, int sb, int xb, int hr, string t)
+        : id(intern(i)), name(n), price(p), successBonus(sb), xpBonus(xb), 
+          heatReduction(hr), type(t) {}
+};
+
+struct Achievement {
+    string id;
+    string name;
+    string description;
+    string icon;
+    
+    Achievement(string i, string n, string d, string ic)
+        : id(i), name(n), description(d), icon(ic) {}
+};
+
+struct RandomEvent {
+    string name;
+    Symbol effect;
+    int value;
+    string type;
+    string message;
+    
+    RandomEvent(string n, string e, int v, string t, string m)
+        : name(n), effect(intern(e)), value(v), type(t), message(m) {}
+};
+
+// Skills every player has; indexes Player::skills
+enum Skill {
+    SKILL_HACKING,
+    SKILL_CRYPTOGRAPHY,
+    SKILL_NETWORKING,
+    SKILL_PROGRAMMING,
+    SKILL_COUNT
+};
+
+constexpr const char* SKILL_NAMES[SKILL_COUNT] = {"hacking", "cryptography", "networking", "programming"};
+
+// Usernames become save file names and URL path segments, so they are
+// kept to 1-32 letters, digits, '_' and '-'
+inline bool validUsername(const string& name) {
+    if (name.empty() || name.size() > MAX_USERNAME_LENGTH) return false;
+    for (char c : name) {
+        if (!isalnum((unsigned char)c) && c != '_' && c != '-') return false;
+    }
+    return true;
+}
+
+inline bool parseSkill(const string& name, Skill& skill) {
+    for (int i = 0; i < SKILL_COUNT; i++) {
+        if (name == SKILL_NAMES[i]) {
+            skill = (Skill)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Groups of Player fields. Mutations mark the groups they touch (see
+// markChanged) so checkAchievements only re-evaluates conditions that could
+// have changed and a delta save only writes what changed since the last one.
+// username, characterType and createdAt never change after creation and
+// have no group.
+enum PlayerField : unsigned {
+    FIELD_LEVEL        = 1u << 0,
+    FIELD_CREDITS      = 1u << 1,
+    FIELD_EARNINGS     = 1u << 2,  // totalEarned
+    FIELD_REPUTATION   = 1u << 3,
+    FIELD_HEAT         = 1u << 4,  // heat and maxHeat
+    FIELD_LOW_HEAT     = 1u << 5,  // lowHeatMissions
+    FIELD_STREAK       = 1u << 6,  // missionStreak
+    FIELD_EQUIPMENT    = 1u << 7,
+    FIELD_SKILLS       = 1u << 8,
+    FIELD_MISSIONS     = 1u << 9,  // completedMissions
+    FIELD_XP           = 1u << 10, // xp, xpToLevel and xpMultiplier
+    FIELD_INVENTORY    = 1u << 11,
+    FIELD_ACHIEVEMENTS = 1u << 12,
+    FIELD_STORY        = 1u << 13, // storyProgress, storyPath and seenBackstory
+    FIELD_FLAGS        = 1u << 14, // doubleRewardNext, gameWon and gameLost
+    FIELD_ALL          = (1u << 15) - 1
+};
+
+// One kind of loot and how many of it the player holds
+struct InventoryStack {
+    Symbol item;
+    int count;
+};
+
+// Adds count of item to inventory, holding at most cap of it; stacks keep
+// the order their items were first found in. Returns the number added.
+inline int addToInventory(vector<InventoryStack>& inventory, Symbol item, int count, int cap = INT_MAX) {
+    for (InventoryStack& stack : inventory) {
+        if (stack.item == item) {
+            int added = max(0, min(count, cap - stack.count));
+            stack.count += added;
+            return added;
+        }
+    }
+    int added = min(count, cap);
+    if (added > 0) {
+        inventory.push_back(InventoryStack{item, added});
+    }
+    return added;
+}
+
+struct Player {
+    string username;
+    Symbol characterType;
+    int level;
+    int xp;
+    int xpToLevel;
+    int credits;
+    int reputation;
+    int heat;
+    int maxHeat;
+    float xpMultiplier;
+    array<int, SKILL_COUNT> skills;           // level per Skill
+    vector<Symbol> equipment;                  // ShopItem ids
+    vector<InventoryStack> inventory;          // loot, counted per item
+    bitset<MAX_MISSION_ID> completedMissions;  // bit per mission id
+    bitset<MAX_ACHIEVEMENTS> achievements;     // bit per GameData::getAchievements() index
+    int storyProgress;
+    Symbol storyPath;
+    bool seenBackstory;
+    int totalEarned;
+    int lowHeatMissions;
+    int missionStreak;
+    bool doubleRewardNext;
+    bool gameWon;
+    bool gameLost;
+    time_t createdAt;
+    time_t lastPlayed;
+    unsigned dirtyFields;    // PlayerField bits changed since the last achievement check
+    unsigned unsavedFields;  // PlayerField bits changed since the last successful save
+    unsigned requeueFields;  // PlayerField bits changed since the last save was queued
+    uint32_t saveSeq;        // saves queued so far; tags each one
+    
+    // Character and equipment modifiers, derived rather than saved. Kept
+    // current by GameRules on creation, purchase and load.
+    int heatReduction;         // heat taken off every mission
+    int successBonus;          // percent, summed over equipment
+    vector<int> gearXpBonuses; // percent, per equipped item with one, in purchase order
+    
+    Player() : characterType(EMPTY_SYMBOL), level(1), xp(0), xpToLevel(100), credits(0), reputation(0), 
+               heat(0), maxHeat(0), xpMultiplier(1.0), storyProgress(0), 
+               storyPath(SYM_INTRO), seenBackstory(false), totalEarned(0),
+               lowHeatMissions(0), missionStreak(0), doubleRewardNext(false),
+               gameWon(false), gameLost(false), dirtyFields(FIELD_ALL), unsavedFields(FIELD_ALL),
+               requeueFields(FIELD_ALL), saveSeq(0), heatReduction(0), successBonus(0) {
+        skills.fill(1);
+        createdAt = time(0);
+        lastPlayed = time(0);
+    }
+};
+
+inline void markUnsaved(Player& player, unsigned fields) {
+    player.unsavedFields |= fields;
+    player.requeueFields |= fields;
+}
+
+inline void markChanged(Player& player, unsigned fields) {
+    player.dirtyFields |= fields;
+    markUnsaved(player, fields);
+}
+
+// Unlock condition for one achievement and the fields it reads
+struct AchievementRule {
+    string achievementId;
+    unsigned fields;
+    bool (*unlocked)(const Player&);
+    
+    AchievementRule(string a, unsigned f, bool (*u)(const Player&))
+        : achievementId(a), fields(f), unlocked(u) {}
+};
+
+// ============================================================================
+// GAME DATA
+// ============================================================================
+
+class GameData {
+public:
+    static vector<Mission> getMissions() {
+        vector<Mission> missions;
+        
+        // Legal missions
+        missions.push_back(Mission(1, "Security Audit", 1, 40, 80, 1, "legal", 0, {"all"}));
+        missions.push_back(Mission(2, "Penetration Testing", 1, 50, 100, 1, "legal", 0, {"all"}));
+        missions.push_back(Mission(3, "Bug Bounty Program", 2, 80, 150, 2, "legal", 0, {"all"}));
+        missions.push_back(Mission(4, "Ethical Hacking Course", 2, 90, 120, 2, "legal", 0, {"all"}));
+        missions.push_back(Mission(5, "Corporate IT Consulting", 3, 150, 300, 4, "legal", 0, {"all"}));
+        missions.push_back(Mission(6, "Cybersecurity Conference", 3, 120, 200, 5, "legal", 0, {"all"}));
+        missions.push_back(Mission(7, "Government Security Contract", 4, 250, 600, 7, "legal", 5, {"all"}));
+        missions.push_back(Mission(8, "White Hat Consulting", 3, 140, 250, 6, "legal", 0, {"all"}));
+        missions.push_back(Mission(9, "Security Training Program", 2, 100, 180, 3, "legal", 0, {"all"}));
+        
+        // Illegal missions
+        missions.push_back(Mission(20, "Phishing Attack", 1, 60, 150, 1, "illegal", 10, {"all"}));
+        missions.push_back(Mission(21, "SQL Injection", 2, 100, 250, 1, "illegal", 15, {"all"}));
+        missions.push_back(Mission(22, "DDoS Campaign", 2, 120, 350, 2, "illegal", 20, {"all"}));
+        missions.push_back(Mission(23, "Ransomware Deployment", 3, 200, 600, 3, "illegal", 30, {"all"}));
+        missions.push_back(Mission(24, "Zero-Day Exploit", 4, 300, 1200, 5, "illegal", 35, {"all"}));
+        missions.push_back(Mission(25, "Corporate Espionage", 4, 350, 1800, 6, "illegal", 40, {"all"}));
+        missions.push_back(Mission(26, "Government Database Breach", 5, 600, 3500, 8, "illegal", 50, {"all"}));
+        missions.push_back(Mission(27, "Cryptocurrency Heist", 5, 800, 6000, 10, "illegal", 55, {"all"}));
+        missions.push_back(Mission(28, "Military Network Infiltration", 5, 1000, 8000, 12, "illegal", 70, {"all"}));
+        missions.push_back(Mission(29, "Black Market Trading", 3, 180, 500, 4, "illegal", 25, {"all"}));
+        
+        // Path specific missions
+        missions.push_back(Mission(30, "Shadow Network Infiltration", 3, 200, 400, 4, "illegal", 20, {"stealth"}));
+        missions.push_back(Mission(31, "Silent Data Exfiltration", 4, 350, 800, 7, "illegal", 25, {"stealth"}));
+        missions.push_back(Mission(32, "Ghost Protocol Operation", 5, 600, 2000, 9, "illegal", 30, {"stealth"}));
+        
+        missions.push_back(Mission(40, "Public Server Takedown", 3, 220, 700, 4, "illegal", 40, {"aggressive"}));
+        missions.push_back(Mission(41, "Mass System Breach", 4, 450, 1500, 7, "illegal", 50, {"aggressive"}));
+        missions.push_back(Mission(42, "Digital Warfare Campaign", 5, 900, 4000, 9, "illegal", 65, {"aggressive"}));
+        
+        missions.push_back(Mission(50, "Balanced Reconnaissance", 3, 210, 550, 4, "illegal", 25, {"neutral"}));
+        missions.push_back(Mission(51, "Strategic Asset Acquisition", 4, 400, 1100, 7, "illegal", 28, {"neutral"}));
+        missions.push_back(Mission(52, "Calculated Strike Operation", 5, 750, 3200, 9, "illegal", 32, {"neutral"}));
+        
+        return missions;
+    }
+    
+    static vector<ShopItem> getShopItems() {
+        vector<ShopItem> items;
+        items.push_back(ShopItem("vpn", "Military VPN", 500, 5, 0, 5, "tool"));
+        items.push_back(ShopItem("laptop", "Elite Laptop", 1000, 10, 10, 0, "gear"));
+        items.push_back(ShopItem("exploit", "Zero-Day Kit", 2000, 15, 0, 0, "tool"));
+        items.push_back(ShopItem("server", "Offshore Server", 3000, 20, 0, 10, "gear"));
+        items.push_back(ShopItem("ai", "AI Assistant", 5000, 25, 20, 0, "tool"));
+        items.push_back(ShopItem("quantum", "Quantum Processor", 10000, 35, 30, 15, "gear"));
+        return items;
+    }
+    
+    static vector<Achievement> getAchievements() {
+        vector<Achievement> achievements;
+        achievements.push_back(Achievement("first_mission", "First Steps", "Complete first mission", "🎯"));
+        achievements.push_back(Achievement("level_5", "Rising Star", "Reach level 5", "⭐"));
+        achievements.push_back(Achievement("level_10", "Expert Hacker", "Reach level 10", "💎"));
+        achievements.push_back(Achievement("level_15", "Elite Operative", "Reach level 15", "👑"));
+        achievements.push_back(Achievement("rich", "Money Maker", "Earn 5000 credits total", "💰"));
+        achievements.push_back(Achievement("notorious", "Most Wanted", "Reach 80 heat", "🔥"));
+        achievements.push_back(Achievement("ghost", "Ghost", "Complete 5 missions with heat below 30", "👻"));
+        achievements.push_back(Achievement("unstoppable", "Unstoppable", "10 mission streak", "⚡"));
+        achievements.push_back(Achievement("shopaholic", "Shopaholic", "Buy all equipment", "🛍️"));
+        achievements.push_back(Achievement("skilled", "Master", "Any skill to level 10", "📊"));
+        achievements.push_back(Achievement("survivor", "Close Call", "Survive with 90+ heat", "🎲"));
+        achievements.push_back(Achievement("legendary", "Legendary", "Complete 20 missions", "🏆"));
+        return achievements;
+    }
+    
+    static vector<AchievementRule> getAchievementRules() {
+        vector<AchievementRule> rules;
+        rules.push_back(AchievementRule("first_mission", FIELD_MISSIONS,
+            [](const Player& p) { return p.completedMissions.count() >= 1; }));
+        rules.push_back(AchievementRule("level_5", FIELD_LEVEL,
+            [](const Player& p) { return p.level >= 5; }));
+        rules.push_back(AchievementRule("level_10", FIELD_LEVEL,
+            [](const Player& p) { return p.level >= 10; }));
+        rules.push_back(AchievementRule("level_15", FIELD_LEVEL,
+            [](const Player& p) { return p.level >= 15; }));
+        rules.push_back(AchievementRule("rich", FIELD_EARNINGS,
+            [](const Player& p) { return p.totalEarned >= 5000; }));
+        rules.push_back(AchievementRule("notorious", FIELD_HEAT,
+            [](const Player& p) { return p.heat >= 80; }));
+        rules.push_back(AchievementRule("ghost", FIELD_LOW_HEAT,
+            [](const Player& p) { return p.lowHeatMissions >= 5; }));
+        rules.push_back(AchievementRule("unstoppable", FIELD_STREAK,
+            [](const Player& p) { return p.missionStreak >= 10; }));
+        rules.push_back(AchievementRule("shopaholic", FIELD_EQUIPMENT,
+            [](const Player& p) { return p.equipment.size() >= 6; }));
+        rules.push_back(AchievementRule("skilled", FIELD_SKILLS,
+            [](const Player& p) {
+                for (int level : p.skills) {
+                    if (level >= 10) return true;
+                }
+                return false;
+            }));
+        rules.push_back(AchievementRule("survivor", FIELD_HEAT,
+            [](const Player& p) { return p.maxHeat >= 90; }));
+        rules.push_back(AchievementRule("legendary", FIELD_MISSIONS,
+            [](const Player& p) { return p.completedMissions.count() >= 20; }));
+        return rules;
+    }
+    
+    // Story paths with missions of their own; missions tagged "all" are open
+    // to every path
+    static vector<string> getStoryPaths() {
+        return {"intro", "stealth", "aggressive", "neutral"};
+    }
+    
+    static vector<RandomEvent> getRandomEvents() {
+        vector<RandomEvent> events;
+        events.push_back(RandomEvent("Laptop Crashed!", "credits", -50, "bad", "💻 Laptop crashed! -50 ¢"));
+        events.push_back(RandomEvent("Found Vulnerability", "doubleReward", 1, "good", "🎯 Vulnerability! Next rewards x2!"));
+        events.push_back(RandomEvent("Police Raid Warning", "heat", 20, "bad", "🚨 Police nearby! Heat +20"));
+        events.push_back(RandomEvent("Hacker Gift", "credits", 200, "good", "🎁 Anonymous gift: +200 ¢!"));
+        events.push_back(RandomEvent("Equipment Upgrade", "xpBonus", 50, "good", "⚡ Equipment upgrade! +50 XP"));
+        events.push_back(RandomEvent("Informant Tip", "heat", -15, "good", "🕵️ Informant helped! Heat -15"));
+        events.push_back(RandomEvent("Hardware Failure", "credits", -100, "bad", "⚠️ Hardware failure! -100 ¢"));
+        events.push_back(RandomEvent("Reputation Boost", "reputation", 50, "good", "⭐ Reputation +50!"));
+        events.push_back(RandomEvent("Security Breach", "heat", 15, "bad", "🔔 Detected! Heat +15"));
+        events.push_back(RandomEvent("Crypto Windfall", "credits", 500, "good", "💰 Bitcoin windfall! +500 ¢"));
+        events.push_back(RandomEvent("VPN Compromised", "heat", 25, "bad", "🔓 VPN compromised! Heat +25"));
+        return events;
+    }
+};
+
+#endif
@@ -0,0 +1,262 @@
+#ifndef GAMEJSON_H
+#define GAMEJSON_H
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "json.hpp"
+#include "gamedata.h"
+
+using namespace std;
+using nlohmann::json;
+
+// ============================================================================
+// JSON MAPPINGS
+// ============================================================================
+//
+// nlohmann::json conversions for the game structs, for API clients that
+// want the full documents. Symbols are written as their names and
+// completion bitsets as lists of set indexes.
+//
+// The inventory is written as a list of {"item": name, "count": n} stacks,
+// one per distinct loot item in the order it was first found. A plain name
+// in the list, as older exports wrote them, reads as a stack of one.
+//
+// Derived Player fields (gear modifiers, dirty bits) are not serialized; run
+// GameRules::refreshModifiers after from_json. The hot stats and mission
+// responses skip this DOM and go through JsonWriter instead.
+
+inline vector<string> symbolNames(const vector<Symbol>& symbols) {
+    vector<string> names;
+    names.reserve(symbols.size());
+    for (Symbol symbol : symbols) {
+        names.push_back(symbolName(symbol));
+    }
+    return names;
+}
+
+// Documents come from clients, so names are looked up rather than interned:
+// anything the game does not already know is rejected
+inline Symbol knownSymbol(const string& name, const char* what) {
+    Symbol symbol;
+    if (!findSymbol(name, symbol)) {
+        throw out_of_range(string("unknown ") + what + " " + name);
+    }
+    return symbol;
+}
+
+inline vector<Symbol> knownSymbols(const vector<string>& names, const char* what) {
+    vector<Symbol> symbols;
+    symbols.reserve(names.size());
+    for (const string& name : names) {
+        symbols.push_back(knownSymbol(name, what));
+    }
+    return symbols;
+}
+
+inline json inventoryJson(const vector<InventoryStack>& inventory) {
+    json stacks = json::array();
+    for (const InventoryStack& stack : inventory) {
+        stacks.push_back(json{{"item", symbolName(stack.item)}, {"count", stack.count}});
+    }
+    return stacks;
+}
+
+inline vector<InventoryStack> inventoryFrom(const json& stacks) {
+    vector<InventoryStack> inventory;
+    for (const json& stack : stacks) {
+        if (stack.is_string()) {
+            addToInventory(inventory, knownSymbol(stack.get<string>(), "item"), 1);
+        } else {
+            int count = stack.value("count", 1);
+            if (count < 1) {
+                throw out_of_range("inventory count below 1");
+            }
+            addToInventory(inventory, knownSymbol(stack.at("item").get<string>(), "item"), count);
+        }
+    }
+    return inventory;
+}
+
+template <size_t N>
+vector<int> setBits(const bitset<N>& bits) {
+    vector<int> indexes;
+    for (size_t i = 0; i < N; i++) {
+        if (bits.test(i)) indexes.push_back((int)i);
+    }
+    return indexes;
+}
+
+template <size_t N>
+bitset<N> bitsFrom(const json& indexes, const char* what) {
+    bitset<N> bits;
+    for (const json& index : indexes) {
+        int i = index.get<int>();
+        if (i < 0 || i >= (int)N) {
+            throw out_of_range(string(what) + " index out of range");
+        }
+        bits.set(i);
+    }
+    return bits;
+}
+
+inline void to_json(json& j, const Player& player) {
+    json skills = json::object();
+    for (int i = 0; i < SKILL_COUNT; i++) {
+        skills[SKILL_NAMES[i]] = player.skills[i];
+    }
+
+    j = json{
+        {"username", player.username},
+        {"character", symbolName(player.characterType)},
+        {"level", player.level},
+        {"xp", player.xp},
+        {"xpToLevel", player.xpToLevel},
+        {"credits", player.credits},
+        {"reputation", player.reputation},
+        {"heat", player.heat},
+        {"maxHeat", player.maxHeat},
+        {"xpMultiplier", player.xpMultiplier},
+        {"skills", skills},
+        {"equipment", symbolNames(player.equipment)},
+        {"inventory", inventoryJson(player.inventory)},
+        {"completedMissions", setBits(player.completedMissions)},
+        {"achievements", setBits(player.achievements)},
+        {"storyProgress", player.storyProgress},
+        {"storyPath", symbolName(player.storyPath)},
+        {"seenBackstory", player.seenBackstory},
+        {"totalEarned", player.totalEarned},
+        {"lowHeatMissions", player.lowHeatMissions},
+        {"missionStreak", player.missionStreak},
+        {"doubleRewardNext", player.doubleRewardNext},
+        {"gameWon", player.gameWon},
+        {"gameLost", player.gameLost},
+        {"createdAt", (long long)player.createdAt},
+        {"lastPlayed", (long long)player.lastPlayed}
+    };
+}
+
+// Fields missing from j keep their new-player defaults. Throws
+// nlohmann::json::exception on wrongly typed fields and out_of_range on
+// unknown skills, names or out-of-range mission/achievement indexes.
+inline void from_json(const json& j, Player& player) {
+    player = Player();
+    player.username = j.at("username").get<string>();
+    player.characterType = knownSymbol(j.value("character", string()), "character");
+    player.level = j.value("level", player.level);
+    player.xp = j.value("xp", player.xp);
+    player.xpToLevel = j.value("xpToLevel", player.xpToLevel);
+    player.credits = j.value("credits", player.credits);
+    player.reputation = j.value("reputation", player.reputation);
+    player.heat = j.value("heat", player.heat);
+    player.maxHeat = j.value("maxHeat", player.maxHeat);
+    player.xpMultiplier = j.value("xpMultiplier", player.xpMultiplier);
+
+    if (j.contains("skills")) {
+        for (const auto& skill : j.at("skills").items()) {
+            Skill index;
+            if (!parseSkill(skill.key(), index)) {
+                throw out_of_range("unknown skill " + skill.key());
+            }
+            player.skills[index] = skill.value().get<int>();
+        }
+    }
+
+    player.equipment = knownSymbols(j.value("equipment", vector<string>()), "item");
+    if (j.contains("inventory")) {
+        player.inventory = inventoryFrom(j.at("inventory"));
+    }
+    if (j.contains("completedMissions")) {
+        player.completedMissions = bitsFrom<MAX_MISSION_ID>(j.at("completedMissions"), "mission");
+    }
+    if (j.contains("achievements")) {
+        player.achievements = bitsFrom<MAX_ACHIEVEMENTS>(j.at("achievements"), "achievement");
+    }
+    player.storyProgress = j.value("storyProgress", player.storyProgress);
+    player.storyPath = knownSymbol(j.value("storyPath", symbolName(SYM_INTRO)), "story path");
+    player.seenBackstory = j.value("seenBackstory", player.seenBackstory);
+    player.totalEarned = j.value("totalEarned", player.totalEarned);
+    player.lowHeatMissions = j.value("lowHeatMissions", player.lowHeatMissions);
+    player.missionStreak = j.value("missionStreak", player.missionStreak);
+    player.doubleRewardNext = j.value("doubleRewardNext", player.doubleRewardNext);
+    player.gameWon = j.value("gameWon", player.gameWon);
+    player.gameLost = j.value("gameLost", player.gameLost);
+    player.createdAt = (time_t)j.value("createdAt", (long long)player.createdAt);
+    player.lastPlayed = (time_t)j.value("lastPlayed", (long long)player.lastPlayed);
+}
+
+// Mission, ShopItem and Achievement have no default constructor, so they
+// convert through adl_serializer specializations instead of free functions
+namespace nlohmann {
+
+template <>
+struct adl_serializer<Mission> {
+    static void to_json(json& j, const Mission& mission) {
+        j = json{
+            {"id", mission.id},
+            {"name", mission.name},
+            {"difficulty", mission.difficulty},
+            {"xpReward", mission.xpReward},
+            {"creditsReward", mission.creditsReward},
+            {"reqLevel", mission.reqLevel},
+            {"type", mission.type},
+            {"heat", mission.heat},
+            {"paths", symbolNames(mission.paths)}
+        };
+    }
+
+    // Paths are looked up after construction, as the constructor interns
+    static Mission from_json(const json& j) {
+        Mission mission(j.at("id").get<int>(), j.at("name").get<string>(), j.at("difficulty").get<int>(),
+                        j.at("xpReward").get<int>(), j.at("creditsReward").get<int>(),
+                        j.at("reqLevel").get<int>(), j.at("type").get<string>(), j.at("heat").get<int>(), {});
+        mission.paths = knownSymbols(j.value("paths", vector<string>()), "story path");
+        return mission;
+    }
+};
+
+template <>
+struct adl_serializer<ShopItem> {
+    static void to_json(json& j, const ShopItem& item) {
+        j = json{
+            {"id", symbolName(item.id)},
+            {"name", item.name},
+            {"price", item.price},
+            {"successBonus", item.successBonus},
+            {"xpBonus", item.xpBonus},
+            {"heatReduction", item.heatReduction},
+            {"type", item.type}
+        };
+    }
+
+    // As for Mission, the id is looked up rather than passed to the constructor
+    static ShopItem from_json(const json& j) {
+        ShopItem item("", j.at("name").get<string>(), j.at("price").get<int>(),
+                      j.value("successBonus", 0), j.value("xpBonus", 0), j.value("heatReduction", 0),
+                      j.at("type").get<string>());
+        item.id = knownSymbol(j.at("id").get<string>(), "item");
+        return item;
+    }
+};
+
+template <>
+struct adl_serializer<Achievement> {
+    static void to_json(json& j, const Achievement& achievement) {
+        j = json{
+            {"id", achievement.id},
+            {"name", achievement.name},
+            {"description", achievement.description},
+            {"icon", achievement.icon}
+        };
+    }
+
+    static Achievement from_json(const json& j) {
+        return Achievement(j.at("id").get<string>(), j.at("name").get<string>(),
+                           j.value("description", string()), j.value("icon", string()));
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,588 @@
+#ifndef GAMERULES_H
+#define GAMERULES_H
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cassert>
+
+#include "gamedata.h"
+#include "random.h"
+
+using namespace std;
+
+// ============================================================================
+// GAME RULES
+// ============================================================================
+//
+// The game mechanics on their own: how a player is created, and what a
+// mission, purchase, upgrade, heat reduction or story choice does to one
+// player. Everything works on a Player the caller already owns and draws
+// randomness from the caller's Rng, so the same rules drive the server
+// (which adds lookup, locking, journaling and messages) and offline tools
+// such as the balance simulator.
+
+enum RuleResult {
+    RULE_OK,
+    RULE_FAILED,           // mission attempted but failed
+    RULE_GAME_LOST,
+    RULE_GAME_WON,
+    RULE_NO_MISSION,
+    RULE_LEVEL_TOO_LOW,
+    RULE_ALREADY_DONE,
+    RULE_NO_ITEM,
+    RULE_ALREADY_OWNED,
+    RULE_NO_CREDITS,
+    RULE_NO_SKILL,
+    RULE_NO_PATH
+};
+
+struct MissionOutcome {
+    RuleResult result;
+    const Mission* mission;
+    int xpGained;
+    int creditsGained;
+    bool leveledUp;
+    const RandomEvent* event;
+
+    MissionOutcome() : result(RULE_NO_MISSION), mission(nullptr), xpGained(0),
+                       creditsGained(0), leveledUp(false), event(nullptr) {}
+};
+
+struct StoryOutcome {
+    RuleResult result;
+    int xpGained;
+    int creditsGained;
+    bool leveledUp;
+
+    StoryOutcome() : result(RULE_NO_PATH), xpGained(0), creditsGained(0), leveledUp(false) {}
+};
+
+class GameRules {
+private:
+    vector<Mission> missions;
+    vector<ShopItem> shopItems;
+    vector<Achievement> achievements;
+    vector<RandomEvent> randomEvents;
+    int inventoryCap;
+
+    // Achievement rules resolved to achievement indexes at startup
+    struct CompiledRule {
+        size_t index;
+        unsigned fields;
+        bool (*unlocked)(const Player&);
+    };
+    vector<CompiledRule> achievementRules;
+
+    void compileAchievementRules() {
+        for (const auto& rule : GameData::getAchievementRules()) {
+            for (size_t i = 0; i < achievements.size(); i++) {
+                if (achievements[i].id == rule.achievementId) {
+                    achievementRules.push_back({i, rule.fields, rule.unlocked});
+                    break;
+                }
+            }
+        }
+    }
+
+    // Mission index, built once in the constructor and read-only afterwards.
+    // Path slot storyPaths.size() stands for any path not listed there.
+    vector<Symbol> storyPaths;
+    vector<vector<const Mission*>> pathMissions; // path slot -> open missions
+    vector<const Mission*> allMissions;
+    vector<int> missionSlots;                    // mission id -> index in missions, -1 if none
+    vector<unsigned> missionPathMasks;           // index in missions -> bit per open path slot
+
+    void buildMissionIndex() {
+        for (const auto& path : GameData::getStoryPaths()) {
+            storyPaths.push_back(intern(path));
+        }
+        size_t otherSlot = storyPaths.size();
+        pathMissions.assign(otherSlot + 1, vector<const Mission*>());
+
+        int maxId = 0;
+        for (const auto& mission : missions) {
+            assert(mission.id >= 0 && mission.id < MAX_MISSION_ID);
+            maxId = max(maxId, mission.id);
+        }
+        missionSlots.assign(maxId + 1, -1);
+        missionPathMasks.assign(missions.size(), 0);
+
+        for (size_t i = 0; i < missions.size(); i++) {
+            const Mission& mission = missions[i];
+            missionSlots[mission.id] = (int)i;
+            allMissions.push_back(&mission);
+
+            for (size_t slot = 0; slot <= otherSlot; slot++) {
+                for (const auto& path : mission.paths) {
+                    if (path == SYM_ALL || (slot < otherSlot && path == storyPaths[slot])) {
+                        missionPathMasks[i] |= 1u << slot;
+                        pathMissions[slot].push_back(&mission);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    size_t pathSlot(Symbol path) const {
+        for (size_t slot = 0; slot < storyPaths.size(); slot++) {
+            if (storyPaths[slot] == path) return slot;
+        }
+        return storyPaths.size();
+    }
+
+    // Spend banked XP on levels; returns true if at least one was gained
+    static bool levelUp(Player& player, bool canWin) {
+        bool leveledUp = false;
+        while (player.xp >= player.xpToLevel) {
+            player.level++;
+            player.xp -= player.xpToLevel;
+            player.xpToLevel = (int)(player.xpToLevel * 1.5);
+            leveledUp = true;
+            markChanged(player, FIELD_LEVEL | FIELD_XP);
+
+            if (player.level % 3 == 0) {
+                player.storyProgress++;
+                markChanged(player, FIELD_STORY);
+            }
+
+            if (canWin && player.level >= 20) {
+                player.gameWon = true;
+                markChanged(player, FIELD_FLAGS);
+            }
+        }
+        return leveledUp;
+    }
+
+public:
+    GameRules() : inventoryCap(DEFAULT_INVENTORY_CAP) {
+        missions = GameData::getMissions();
+        shopItems = GameData::getShopItems();
+        achievements = GameData::getAchievements();
+        assert(achievements.size() <= (size_t)MAX_ACHIEVEMENTS);
+        randomEvents = GameData::getRandomEvents();
+        compileAchievementRules();
+        buildMissionIndex();
+    }
+
+    // Index and missions point into this object
+    GameRules(const GameRules&) = delete;
+    GameRules& operator=(const GameRules&) = delete;
+
+    const vector<const Mission*>& getAllMissions() const { return allMissions; }
+    const vector<ShopItem>& getShopItems() const { return shopItems; }
+    const vector<Achievement>& getAchievements() const { return achievements; }
+
+    // Most of one loot item a player can hold; further drops of it are lost.
+    // Set before serving requests.
+    int getInventoryCap() const { return inventoryCap; }
+    void setInventoryCap(int cap) { inventoryCap = max(1, cap); }
+
+    // Missions open to the player's story path
+    const vector<const Mission*>& getAvailableMissions(const Player& player) const {
+        return pathMissions[pathSlot(player.storyPath)];
+    }
+
+    // Find a mission open to the player by id, nullptr if there is none
+    const Mission* findMission(int missionId, const Player& player) const {
+        if (missionId < 0 || missionId >= (int)missionSlots.size()) return nullptr;
+        int index = missionSlots[missionId];
+        if (index < 0) return nullptr;
+        if (!(missionPathMasks[index] & (1u << pathSlot(player.storyPath)))) return nullptr;
+        return &missions[index];
+    }
+
+    const ShopItem* findItem(const string& itemId) const {
+        Symbol id;
+        if (!symbols().find(itemId, id)) return nullptr;
+        for (const auto& item : shopItems) {
+            if (item.id == id) return &item;
+        }
+        return nullptr;
+    }
+
+    // Heat shaved off every mission by character and equipment
+    int calculateHeatReduction(const Player& player) const {
+        return player.heatReduction;
+    }
+
+    // Recompute the cached character and equipment modifiers from scratch;
+    // needed after a player is decoded from a save, pack or journal
+    void refreshModifiers(Player& player) const {
+        player.heatReduction = player.characterType == SYM_GHOST ? 10 : 0;
+        player.successBonus = 0;
+        player.gearXpBonuses.clear();
+        for (Symbol itemId : player.equipment) {
+            for (const auto& item : shopItems) {
+                if (item.id == itemId) {
+                    addModifiers(player, item);
+                    break;
+                }
+            }
+        }
+    }
+
+    static void addModifiers(Player& player, const ShopItem& item) {
+        player.heatReduction += item.heatReduction;
+        player.successBonus += item.successBonus;
+        if (item.xpBonus > 0) {
+            player.gearXpBonuses.push_back(item.xpBonus);
+        }
+    }
+
+    // Check achievements whose conditions read a field changed since the
+    // last check
+    vector<Achievement> checkAchievements(Player& player) const {
+        vector<Achievement> newAchievements;
+        unsigned dirty = player.dirtyFields;
+        player.dirtyFields = 0;
+
+        for (const auto& rule : achievementRules) {
+            if (!(rule.fields & dirty)) continue;
+            if (player.achievements.test(rule.index)) continue;
+
+            if (rule.unlocked(player)) {
+                player.achievements.set(rule.index);
+                newAchievements.push_back(achievements[rule.index]);
+            }
+        }
+        if (!newAchievements.empty()) {
+            markUnsaved(player, FIELD_ACHIEVEMENTS);
+        }
+
+        return newAchievements;
+    }
+
+    // Random event (15% chance)
+    const RandomEvent* triggerRandomEvent(Rng& rng) const {
+        if (rng.chance(15)) {
+            int index = rng.below((uint32_t)randomEvents.size());
+            return &randomEvents[index];
+        }
+        return nullptr;
+    }
+
+    // Symbol for a playable character's name; false for anything else.
+    // Never interns, so client input cannot grow the symbol table.
+    bool parseCharacter(const string& name, Symbol& character) const {
+        return findSymbol(name, character) &&
+               (character == SYM_GHOST || character == SYM_CIPHER ||
+                character == SYM_REBEL || character == SYM_ARCHITECT);
+    }
+
+    // Symbol for a story path a player can choose (any path but the
+    // intro); false for anything else
+    bool parseStoryPath(const string& name, Symbol& path) const {
+        return findSymbol(name, path) && path != SYM_INTRO &&
+               find(storyPaths.begin(), storyPaths.end(), path) != storyPaths.end();
+    }
+
+    // Check a player state supplied from outside (an import) against what
+    // play can produce: a valid username, a playable character and known
+    // story path, shop items owned at most once, known loot and values in
+    // range. Loot stacks are clamped to the inventory cap. On failure
+    // problem says why.
+    bool validatePlayer(Player& player, string& problem) const {
+        Symbol character;
+        if (!validUsername(player.username)) {
+            problem = "invalid username";
+        } else if (!parseCharacter(symbolName(player.characterType), character)) {
+            problem = "unknown character";
+        } else if (find(storyPaths.begin(), storyPaths.end(), player.storyPath) == storyPaths.end()) {
+            problem = "unknown story path";
+        } else if (player.level < 1 || player.level > MAX_LEVEL) {
+            problem = "level out of range";
+        } else if (player.xpToLevel < 100 || player.xp < 0 || player.xp >= player.xpToLevel) {
+            problem = "xp out of range";
+        } else if (player.credits < 0 || player.reputation < 0 || player.totalEarned < 0 ||
+                   player.storyProgress < 0 || player.lowHeatMissions < 0 || player.missionStreak < 0) {
+            problem = "negative counter";
+        } else if (player.heat < 0 || player.maxHeat < player.heat || player.maxHeat > 100) {
+            problem = "heat out of range";
+        } else if (!(player.xpMultiplier >= 1.0f && player.xpMultiplier <= 1.15f)) {
+            problem = "xpMultiplier out of range";
+        }
+        if (!problem.empty()) return false;
+
+        for (int level : player.skills) {
+            if (level < 1 || level > MAX_SKILL_LEVEL) {
+                problem = "skill level out of range";
+                return false;
+            }
+        }
+        for (auto it = player.equipment.begin(); it != player.equipment.end(); ++it) {
+            if (!findItem(symbolName(*it)) || find(player.equipment.begin(), it, *it) != it) {
+                problem = "unknown or repeated equipment";
+                return false;
+            }
+        }
+        for (InventoryStack& stack : player.inventory) {
+            if (find(begin(LOOT_ITEMS), end(LOOT_ITEMS), stack.item) == end(LOOT_ITEMS)) {
+                problem = "unknown inventory item";
+                return false;
+            }
+            stack.count = min(stack.count, inventoryCap);
+        }
+        return true;
+    }
+
+    // A fresh player with the character's starting bonuses; characterType
+    // comes from parseCharacter()
+    Player newPlayer(const string& username, Symbol characterType) const {
+        Player player;
+        player.username = username;
+        player.characterType = characterType;
+
+        if (player.characterType == SYM_GHOST) {
+            player.skills[SKILL_HACKING] += 2;
+        } else if (player.characterType == SYM_CIPHER) {
+            player.skills[SKILL_CRYPTOGRAPHY] += 2;
+            player.xpMultiplier = 1.15;
+        } else if (player.characterType == SYM_REBEL) {
+            player.skills[SKILL_NETWORKING] += 2;
+            player.reputation = 50;
+        } else if (player.characterType == SYM_ARCHITECT) {
+            player.skills[SKILL_PROGRAMMING] += 2;
+            player.credits = 100;
+        }
+        refreshModifiers(player);
+        return player;
+    }
+
+    // Attempt a mission; successRate is the percent chance it succeeds
+    // before the equipment's success bonus is added
+    MissionOutcome runMission(Player& player, int missionId, int successRate, Rng& rng) const {
+        MissionOutcome outcome;
+
+        if (player.gameLost) {
+            outcome.result = RULE_GAME_LOST;
+            return outcome;
+        }
+
+        if (player.gameWon) {
+            outcome.result = RULE_GAME_WON;
+            return outcome;
+        }
+
+        const Mission* mission = findMission(missionId, player);
+        outcome.mission = mission;
+
+        if (!mission) {
+            outcome.result = RULE_NO_MISSION;
+            return outcome;
+        }
+
+        if (player.level < mission->reqLevel) {
+            outcome.result = RULE_LEVEL_TOO_LOW;
+            return outcome;
+        }
+
+        if (player.completedMissions.test(missionId)) {
+            outcome.result = RULE_ALREADY_DONE;
+            return outcome;
+        }
+
+        // Mission success check
+        int roll = (int)rng.below(100);
+        bool success = roll < successRate + player.successBonus;
+
+        const RandomEvent* event = triggerRandomEvent(rng);
+
+        if (!success) {
+            player.reputation -= 5;
+            player.heat += 10;
+            player.missionStreak = 0;
+            markChanged(player, FIELD_REPUTATION | FIELD_HEAT | FIELD_STREAK);
+
+            if (player.heat >= 100) {
+                player.gameLost = true;
+                markChanged(player, FIELD_FLAGS);
+            }
+
+            player.lastPlayed = time(0);
+            outcome.result = RULE_FAILED;
+            return outcome;
+        }
+
+        int xpGained = mission->xpReward;
+        int creditsGained = mission->creditsReward;
+
+        // Double reward
+        if (player.doubleRewardNext) {
+            xpGained *= 2;
+            creditsGained *= 2;
+            player.doubleRewardNext = false;
+            markChanged(player, FIELD_FLAGS);
+        }
+
+        // XP multiplier
+        xpGained = (int)(xpGained * player.xpMultiplier);
+
+        // Equipment XP bonus, truncated after each item
+        for (int bonus : player.gearXpBonuses) {
+            xpGained = (int)(xpGained * (1.0 + bonus / 100.0));
+        }
+
+        player.xp += xpGained;
+        player.credits += creditsGained;
+        player.totalEarned += creditsGained;
+        player.reputation += mission->difficulty * 10;
+        player.completedMissions.set(missionId);
+        player.missionStreak++;
+
+        // Heat
+        int heatGain = max(0, mission->heat - calculateHeatReduction(player));
+        player.heat = min(100, player.heat + heatGain);
+        if (player.heat > player.maxHeat) {
+            player.maxHeat = player.heat;
+        }
+
+        if (player.heat < 30) {
+            player.lowHeatMissions++;
+        }
+
+        markChanged(player, FIELD_XP | FIELD_CREDITS | FIELD_EARNINGS | FIELD_REPUTATION |
+                            FIELD_MISSIONS | FIELD_STREAK | FIELD_HEAT | FIELD_LOW_HEAT);
+
+        // Item drop (30% chance)
+        if (rng.chance(30)) {
+            if (addToInventory(player.inventory, LOOT_ITEMS[rng.below(LOOT_ITEM_COUNT)], 1, inventoryCap) > 0) {
+                markChanged(player, FIELD_INVENTORY);
+            }
+        }
+
+        bool leveledUp = levelUp(player, true);
+
+        checkAchievements(player);
+
+        // Apply random event
+        if (event) {
+            if (event->effect == EFFECT_CREDITS) {
+                player.credits = max(0, player.credits + event->value);
+                markChanged(player, FIELD_CREDITS);
+            } else if (event->effect == EFFECT_HEAT) {
+                player.heat = max(0, min(100, player.heat + event->value));
+                markChanged(player, FIELD_HEAT);
+            } else if (event->effect == EFFECT_DOUBLE_REWARD) {
+                player.doubleRewardNext = true;
+                markChanged(player, FIELD_FLAGS);
+            } else if (event->effect == EFFECT_XP_BONUS) {
+                player.xp += event->value;
+                markChanged(player, FIELD_XP);
+            } else if (event->effect == EFFECT_REPUTATION) {
+                player.reputation += event->value;
+                markChanged(player, FIELD_REPUTATION);
+            }
+        }
+
+        // Check game over
+        if (player.heat >= 100) {
+            player.gameLost = true;
+            markChanged(player, FIELD_FLAGS);
+        }
+
+        player.lastPlayed = time(0);
+
+        outcome.result = RULE_OK;
+        outcome.xpGained = xpGained;
+        outcome.creditsGained = creditsGained;
+        outcome.leveledUp = leveledUp;
+        outcome.event = event;
+        return outcome;
+    }
+
+    // Reduce heat by 20 for 300 credits
+    RuleResult reduceHeat(Player& player) const {
+        if (player.credits < 300) {
+            return RULE_NO_CREDITS;
+        }
+
+        player.credits -= 300;
+        player.heat = max(0, player.heat - 20);
+        markChanged(player, FIELD_CREDITS | FIELD_HEAT);
+        return RULE_OK;
+    }
+
+    RuleResult buyItem(Player& player, const ShopItem& item) const {
+        for (const auto& owned : player.equipment) {
+            if (owned == item.id) {
+                return RULE_ALREADY_OWNED;
+            }
+        }
+
+        if (player.credits < item.price) {
+            return RULE_NO_CREDITS;
+        }
+
+        player.credits -= item.price;
+        player.equipment.push_back(item.id);
+        addModifiers(player, item);
+        markChanged(player, FIELD_CREDITS | FIELD_EQUIPMENT);
+
+        checkAchievements(player);
+        return RULE_OK;
+    }
+
+    // Next level of a skill costs 500 credits per current level
+    RuleResult upgradeSkill(Player& player, Skill skill) const {
+        int cost = player.skills[skill] * 500;
+
+        if (player.credits < cost) {
+            return RULE_NO_CREDITS;
+        }
+
+        player.credits -= cost;
+        player.skills[skill]++;
+        markChanged(player, FIELD_CREDITS | FIELD_SKILLS);
+
+        checkAchievements(player);
+        return RULE_OK;
+    }
+
+    // Cool down by amount, not below zero; RULE_FAILED if there was no heat
+    RuleResult decayHeat(Player& player, int amount) const {
+        if (player.heat <= 0) {
+            return RULE_FAILED;
+        }
+
+        player.heat = max(0, player.heat - amount);
+        markChanged(player, FIELD_HEAT);
+        return RULE_OK;
+    }
+
+    // Commit to a story path; choices other than stealth and aggressive
+    // pay the neutral reward. RULE_NO_PATH leaves the player unchanged.
+    StoryOutcome storyChoice(Player& player, const string& choice) const {
+        StoryOutcome outcome;
+        int xpReward = 0, creditsReward = 0, repReward = 0;
+        Symbol path;
+        if (!parseStoryPath(choice, path)) {
+            return outcome;
+        }
+
+        if (path == SYM_STEALTH) {
+            xpReward = 100; creditsReward = 200; repReward = 10;
+        } else if (path == SYM_AGGRESSIVE) {
+            xpReward = 150; creditsReward = 100; repReward = 20;
+        } else {
+            xpReward = 125; creditsReward = 150; repReward = 15;
+        }
+
+        xpReward = (int)(xpReward * player.xpMultiplier);
+
+        player.xp += xpReward;
+        player.credits += creditsReward;
+        player.reputation += repReward;
+        player.storyPath = path;
+        markChanged(player, FIELD_XP | FIELD_CREDITS | FIELD_REPUTATION | FIELD_STORY);
+
+        outcome.result = RULE_OK;
+        outcome.xpGained = xpReward;
+        outcome.creditsGained = creditsReward;
+        outcome.leveledUp = levelUp(player, false);
+        return outcome;
+    }
+};
+
+#endif
@@ -0,0 +1,1312 @@
+#ifndef GAMESERVER_H
+#define GAMESERVER_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <ctime>
+#include <cstdlib>
+#include <algorithm>
+#include <bitset>
+#include <cassert>
+#include <filesystem>
+#include <memory>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+#include <cstdio>
+#include <atomic>
+#include <random>
+#include <unordered_map>
+
+#include "gamedata.h"
+#include "playerregistry.h"
+#include "savefile.h"
+#include "journal.h"
+#include "logger.h"
+#include "leaderboard.h"
+#include "random.h"
+#include "gamerules.h"
+#include "playercolumns.h"
+#include "textformat.h"
+#include "savequeue.h"
+#include "savestore.h"
+
+using namespace std;
+
+// ============================================================================
+// BATCH ACTIONS
+// ============================================================================
+
+// One player action in a batch. arg carries the character, item, skill or
+// path name depending on op; missionId and successRate are mission-only.
+struct BatchAction {
+    string username;
+    string op;
+    string arg;
+    int missionId;
+    int successRate;
+    
+    BatchAction() : missionId(0), successRate(0) {}
+};
+
+// Parses one batch line in REPL syntax, e.g. "mission alice 3 70" or
+// "buy alice vpn". Returns false on a malformed line.
+inline bool parseBatchAction(const string& line, BatchAction& action) {
+    stringstream in(line);
+    action = BatchAction();
+    if (!(in >> action.op >> action.username)) return false;
+    
+    if (action.op == "mission") {
+        return (bool)(in >> action.missionId >> action.successRate);
+    }
+    if (action.op == "create" || action.op == "buy" || action.op == "upgrade" || action.op == "story") {
+        return (bool)(in >> action.arg);
+    }
+    return action.op == "heat" || action.op == "stats";
+}
+
+// ============================================================================
+// GAME SERVER CLASS
+// ============================================================================
+
+class GameServer {
+private:
+    ShardedRegistry<Player> players;
+    GameRules rules;
+    Leaderboard leaderboard;
+    unique_ptr<PlayerColumns> columns;  // optional, see enableColumns()
+    
+    // Write-ahead journal and background snapshots; inactive until
+    // enableJournal() is called
+    unique_ptr<Journal> journal;
+    string journalDir;
+    static constexpr const char* JOURNAL_ERROR = "ERROR: Change could not be written to the journal";
+    int snapshotIntervalSec;
+    thread snapshotter;
+    mutex snapshotLock;
+    condition_variable snapshotWake;
+    bool stopping;
+    mutex checkpointLock;
+    
+    // Each thread draws from its own generator, seeded from rngSeed and the
+    // order in which threads first draw. Changing rngEpoch makes every
+    // thread reseed before its next draw.
+    atomic<uint64_t> rngSeed;
+    atomic<uint64_t> rngEpoch;
+    atomic<uint64_t> rngStreams;
+    static inline atomic<uint64_t> nextRngEpoch{1};
+    
+    // Packed save store; when unset, saves go to one .sav file per player
+    unique_ptr<SaveStore> store;
+    
+    // Resident player budget, 0 for none (see limitResidentPlayers()). Over
+    // budget, the evictor writes idle players back to the store and drops
+    // them; the next access faults them in again.
+    size_t residentLimit;
+    thread evictor;
+    condition_variable evictWake;        // waits on snapshotLock, like the snapshotter
+    atomic<uint64_t> faults;
+    atomic<uint64_t> evictions;
+    
+    // Saves are written off the request thread, keyed by username. Declared
+    // last so it drains before anything above is torn down.
+    SaveQueue saves{[this](const string& username, const string& record) {
+        return store ? store->write(username, record) : SaveQueue::writeFile(username + ".sav", record);
+    }};
+    
+    Rng& rng() {
+        thread_local Rng local;
+        thread_local uint64_t localEpoch = 0;
+        uint64_t epoch = rngEpoch.load(memory_order_acquire);
+        if (localEpoch != epoch) {
+            uint64_t stream = rngStreams.fetch_add(1, memory_order_relaxed);
+            local.reseed(rngSeed.load(memory_order_relaxed) ^ (stream * 0x9e3779b97f4a7c15ull));
+            localEpoch = epoch;
+        }
+        return local;
+    }
+    
+    // Record the player's state after a change: queue their new rank,
+    // refresh their column row and journal the new state. Callers still hold
+    // the player's registry handle, so journal entries and ranks for one
+    // player stay in order. finishChanges() completes the change.
+    void recordChange(JournalOp op, const Player& player) {
+        leaderboard.queueUpdate(player.username, player.level, player.credits);
+        if (columns) columns->store(player);
+        if (!journal) return;
+        string record;
+        SaveFile::encode(player, record);
+        unsyncedLsn() = journal->append(op, record);
+    }
+    
+    // Journal position of the last change this thread recorded and has not
+    // yet waited on, 0 for none
+    static uint64_t& unsyncedLsn() {
+        thread_local uint64_t lsn = 0;
+        return lsn;
+    }
+    
+    // Rank the players this thread changed and wait until the changes are
+    // fsynced, so a reply is never sent for a change a crash could still
+    // lose. Call once the player's handle is released: the leaderboard's
+    // exclusive lock is then taken outside the shard lock, and other
+    // requests on the shard can join the same group commit. False if the
+    // journal failed first.
+    bool finishChanges() {
+        leaderboard.applyQueued();
+        uint64_t lsn = unsyncedLsn();
+        unsyncedLsn() = 0;
+        return lsn == 0 || !journal || journal->waitDurable(lsn);
+    }
+    
+    string durableResult(string result) {
+        return finishChanges() ? result : JOURNAL_ERROR;
+    }
+    
+    // Run action on username's record and reply once its change is durable
+    template <typename Action>
+    string withPlayer(const string& username, Action action) {
+        string result;
+        {
+            auto handle = acquirePlayer(username);
+            if (!handle) {
+                return "ERROR: Player not found";
+            }
+            result = action(*handle);
+        }
+        return durableResult(move(result));
+    }
+    
+    // Newest saved state of an evicted player: from the save queue while
+    // its write-back is still pending, else from the store. player is left
+    // alone if there is none.
+    bool readEvicted(const string& username, Player& player) {
+        if (!residentLimit) return false;
+        Player saved;
+        if (!saves.peek(username, saved) && !store->read(username, saved)) {
+            return false;
+        }
+        rules.refreshModifiers(saved);
+        saved.unsavedFields = saved.requeueFields = 0;  // stored, or about to be
+        player = move(saved);
+        return true;
+    }
+    
+    // Bring username back into the registry if it was evicted. Returns true
+    // if the player is resident afterwards. The saved state is read under
+    // the shard lock, so it cannot change underneath (see decayHeat).
+    bool faultIn(const string& username) {
+        bool loaded = false;
+        bool resident = players.insertLoaded(username, [&](Player& player) {
+            loaded = readEvicted(username, player);
+            return loaded;
+        }, false);
+        if (loaded) {
+            faults.fetch_add(1, memory_order_relaxed);
+            noteResident();
+        }
+        return resident;
+    }
+    
+    // For a slot just claimed with players.insert: if the name belongs to an
+    // evicted player, put them back in it instead. The shard lock held by
+    // the handle keeps the evictor out between the insert and the check.
+    bool restoreEvicted(const string& username, ShardedRegistry<Player>::Handle& handle) {
+        if (!readEvicted(username, *handle)) return false;
+        faults.fetch_add(1, memory_order_relaxed);
+        noteResident();
+        return true;
+    }
+    
+    // decayHeat for an evicted player: cools the saved state and queues it
+    // for write-back. The caller holds the shard lock with the player
+    // absent, which stands in for the handle (no fault-in can read the old
+    // state meanwhile, and the column row has a single writer).
+    bool decayEvicted(const string& username, int amount) {
+        Player player;
+        if (!readEvicted(username, player) || rules.decayHeat(player, amount) != RULE_OK) {
+            return false;
+        }
+        saves.save(username, player, [this, username](bool ok) {
+            if (!ok) writeBackFailed(username, "heat decay");
+        }, player.unsavedFields);
+        recordChange(JOURNAL_HEAT, player);
+        return true;
+    }
+    
+    // A write-back of an evicted player failed, so the store still holds an
+    // older record. Runs on the save queue's writer while the failed copy is
+    // still queued: fault the player back in from it and mark every field
+    // unsaved, so nothing is lost and the next save is a full record.
+    void writeBackFailed(const string& username, const char* what) {
+        gameLog().log(LOG_ERROR, "save_failed", username, what);
+        auto handle = acquirePlayer(username);
+        if (handle) markUnsaved(*handle, FIELD_ALL);
+    }
+    
+    // Registry lookups for the request paths: as players.acquire/read, but
+    // an evicted player is faulted in first. The evictor can take the player
+    // again before it is locked, hence the loop.
+    ShardedRegistry<Player>::Handle acquirePlayer(const string& username) {
+        auto handle = players.acquire(username);
+        while (!handle && faultIn(username)) {
+            handle = players.acquire(username);
+        }
+        return handle;
+    }
+    
+    ShardedRegistry<Player>::ConstHandle readPlayer(const string& username) {
+        auto handle = players.read(username);
+        while (!handle && faultIn(username)) {
+            handle = players.read(username);
+        }
+        return handle;
+    }
+    
+    // Wake the evictor once the registry goes over budget
+    void noteResident() {
+        if (residentLimit && players.size() > residentLimit) {
+            evictWake.notify_one();
+        }
+    }
+    
+    // Trim the registry to 90% of the budget so the evictor does not run
+    // again for every player faulted in. Dirty players are queued for
+    // write-back before they go; clean ones are already in the store.
+    size_t evictIdle() {
+        size_t target = residentLimit - residentLimit / 10;
+        size_t removed = players.evict(target, [&](const string& username, Player& player, bool dirty) {
+            if (!dirty || !player.unsavedFields) return;
+            saves.save(username, player, [this, username](bool ok) {
+                if (!ok) writeBackFailed(username, "write-back");
+            }, player.unsavedFields);
+        });
+        evictions.fetch_add(removed, memory_order_relaxed);
+        
+        if (removed > 0) {
+            char detail[64];
+            snprintf(detail, sizeof(detail), "%zu players, %zu resident", removed, players.size());
+            gameLog().log(LOG_DEBUG, "players_evicted", "", detail);
+        }
+        return removed;
+    }
+    
+    void evictLoop() {
+        unique_lock<mutex> guard(snapshotLock);
+        while (!stopping) {
+            evictWake.wait_for(guard, chrono::seconds(1), [this] {
+                return stopping || players.size() > residentLimit;
+            });
+            if (stopping) break;
+            guard.unlock();
+            evictIdle();
+            guard.lock();
+        }
+    }
+    
+    // Registry insert used when restoring players from packs and the journal
+    void restorePlayer(Player&& player) {
+        rules.refreshModifiers(player);
+        string username = player.username;
+        leaderboard.update(username, player.level, player.credits);
+        {
+            auto handle = players.put(username, move(player));
+            if (columns) columns->store(*handle);
+        }
+        noteResident();
+    }
+    
+    // Snapshot numbers in dir (snapshot.<n>.pack), ascending. Snapshot n
+    // holds everything logged before journal segment n.
+    static vector<uint64_t> snapshots(const string& dir) {
+        vector<uint64_t> found;
+        error_code ec;
+        for (const auto& entry : filesystem::directory_iterator(dir, ec)) {
+            string name = entry.path().filename().string();
+            if (name.compare(0, 9, "snapshot.") != 0 || name.size() <= 14 ||
+                name.compare(name.size() - 5, 5, ".pack") != 0) {
+                continue;
+            }
+            found.push_back(strtoull(name.c_str() + 9, nullptr, 10));
+        }
+        sort(found.begin(), found.end());
+        return found;
+    }
+    
+    void snapshotLoop() {
+        unique_lock<mutex> guard(snapshotLock);
+        while (!stopping) {
+            snapshotWake.wait_for(guard, chrono::seconds(snapshotIntervalSec), [this] { return stopping; });
+            if (stopping) break;
+            guard.unlock();
+            checkpoint();
+            guard.lock();
+        }
+    }
+    
+    bool writePack(const string& path, bool sync) {
+        ofstream file(path, ios::binary | ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+        
+        string buffer;
+        SaveFile::encodePackHeader(buffer);
+        players.forEach([&](const string&, Player& player) {
+            SaveFile::encode(player, buffer);
+            if (buffer.size() >= (1 << 20)) {
+                file.write(buffer.data(), buffer.size());
+                buffer.clear();
+            }
+        });
+        file.write(buffer.data(), buffer.size());
+        file.close();
+        
+        if (!file) {
+            return false;
+        }
+        if (sync) {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0 || fsync(fd) != 0) {
+                if (fd >= 0) ::close(fd);
+                return false;
+            }
+            ::close(fd);
+        }
+        return true;
+    }
+    
+    // Action bodies shared by the single-player calls and applyBatch; the
+    // caller holds the player's registry handle
+    string missionFor(Player& player, int missionId, int successRate, chrono::steady_clock::time_point started) {
+        MissionOutcome outcome = rules.runMission(player, missionId, successRate, rng());
+        
+        switch (outcome.result) {
+            case RULE_GAME_LOST: return "ERROR: Game Over! You were caught!";
+            case RULE_GAME_WON: return "ERROR: You already won!";
+            case RULE_NO_MISSION: return "ERROR: Mission not found";
+            case RULE_LEVEL_TOO_LOW: return "ERROR: Level too low";
+            case RULE_ALREADY_DONE: return "ERROR: Already completed";
+            default: break;
+        }
+        
+        const Mission* mission = outcome.mission;
+        recordChange(JOURNAL_MISSION, player);
+        
+        if (outcome.result == RULE_FAILED) {
+            gameLog().log(LOG_INFO, "mission_failed", player.username, mission->name.c_str(),
+                          mission->id, player.heat, elapsedUs(started));
+            return "FAIL: Mission failed! Security detected you.";
+        }
+        
+        stringstream ss;
+        ss << "SUCCESS: Mission completed! +" << outcome.xpGained << " XP, +" << outcome.creditsGained << " credits";
+        if (outcome.leveledUp) ss << " | LEVEL UP to " << player.level << "!";
+        if (player.gameWon) ss << " | YOU WON THE GAME!";
+        if (player.gameLost) ss << " | GAME OVER - Heat reached 100!";
+        if (outcome.event) ss << " | EVENT: " << outcome.event->message;
+        
+        gameLog().log(LOG_INFO, "mission_completed", player.username, mission->name.c_str(),
+                      mission->id, player.heat, elapsedUs(started));
+        
+        return ss.str();
+    }
+    
+    string reduceHeatFor(Player& player) {
+        if (rules.reduceHeat(player) != RULE_OK) {
+            return "ERROR: Need 300 credits";
+        }
+        recordChange(JOURNAL_HEAT, player);
+        
+        return "SUCCESS: Heat reduced by 20!";
+    }
+    
+    string buyItemFor(Player& player, const string& itemId) {
+        const ShopItem* item = rules.findItem(itemId);
+        if (!item) {
+            return "ERROR: Item not found";
+        }
+        
+        switch (rules.buyItem(player, *item)) {
+            case RULE_ALREADY_OWNED: return "ERROR: Already owned";
+            case RULE_NO_CREDITS: return "ERROR: Not enough credits";
+            default: break;
+        }
+        recordChange(JOURNAL_BUY, player);
+        
+        gameLog().log(LOG_INFO, "item_bought", player.username, item->name.c_str());
+        return "SUCCESS: " + item->name + " purchased!";
+    }
+    
+    string upgradeSkillFor(Player& player, const string& skillName) {
+        Skill skill;
+        if (!parseSkill(skillName, skill)) {
+            return "ERROR: Invalid skill";
+        }
+        
+        if (rules.upgradeSkill(player, skill) != RULE_OK) {
+            return "ERROR: Not enough credits";
+        }
+        recordChange(JOURNAL_UPGRADE, player);
+        
+        if (gameLog().enabled(LOG_INFO)) {
+            char detail[64];
+            snprintf(detail, sizeof(detail), "%s to %d", skillName.c_str(), player.skills[skill]);
+            gameLog().log(LOG_INFO, "skill_upgraded", player.username, detail);
+        }
+        
+        stringstream ss;
+        ss << "SUCCESS: " << skillName << " upgraded to level " << player.skills[skill];
+        return ss.str();
+    }
+    
+    string storyChoiceFor(Player& player, const string& choice) {
+        StoryOutcome outcome = rules.storyChoice(player, choice);
+        if (outcome.result != RULE_OK) {
+            return "ERROR: Unknown story path";
+        }
+        recordChange(JOURNAL_STORY, player);
+        
+        gameLog().log(LOG_INFO, "path_chosen", player.username, choice.c_str());
+        
+        stringstream ss;
+        ss << "SUCCESS: Path chosen! +" << outcome.xpGained << " XP, +" << outcome.creditsGained << " credits";
+        if (outcome.leveledUp) ss << " | LEVEL UP!";
+        return ss.str();
+    }
+    
+    // Appends the stats report for player to out
+    void appendStats(string& out, const Player& player) const {
+        out += "\n=== PLAYER STATS ===\nName: ";
+        out += player.username;
+        out += "\nCharacter: ";
+        out += symbolName(player.characterType);
+        out += "\nLevel: ";
+        appendInt(out, player.level);
+        out += "\nXP: ";
+        appendInt(out, player.xp);
+        out += '/';
+        appendInt(out, player.xpToLevel);
+        out += "\nCredits: ";
+        appendInt(out, player.credits);
+        out += " ¢\nReputation: ";
+        appendInt(out, player.reputation);
+        out += "\nHeat: ";
+        appendInt(out, player.heat);
+        out += "/100";
+        if (player.heat >= 80) out += " ⚠️ WARNING!";
+        out += '\n';
+        
+        out += "\n=== SKILLS ===\n";
+        for (int i = 0; i < SKILL_COUNT; i++) {
+            out += SKILL_NAMES[i];
+            out += ": Level ";
+            appendInt(out, player.skills[i]);
+            out += '\n';
+        }
+        
+        out += "\n=== EQUIPMENT ===\n";
+        if (player.equipment.empty()) {
+            out += "None\n";
+        } else {
+            for (Symbol item : player.equipment) {
+                out += "- ";
+                out += symbolName(item);
+                out += '\n';
+            }
+        }
+        
+        out += "\n=== INVENTORY ===\n";
+        if (player.inventory.empty()) {
+            out += "Empty\n";
+        } else {
+            for (size_t i = 0; i < player.inventory.size(); i++) {
+                appendInt(out, (long long)i + 1);
+                out += ". ";
+                out += symbolName(player.inventory[i].item);
+                out += " x";
+                appendInt(out, player.inventory[i].count);
+                out += '\n';
+            }
+        }
+        
+        out += "\n=== PROGRESS ===\nMissions Completed: ";
+        appendInt(out, (long long)player.completedMissions.count());
+        out += "\nAchievements Unlocked: ";
+        appendInt(out, (long long)player.achievements.count());
+        out += '/';
+        appendInt(out, (long long)rules.getAchievements().size());
+        out += "\nStory Path: ";
+        out += symbolName(player.storyPath);
+        out += "\nCurrent Streak: ";
+        appendInt(out, player.missionStreak);
+        out += '\n';
+        
+        if (player.gameWon) {
+            out += "\n🎉 YOU WON! You are a HACKER TYCOON! 🎉\n";
+        }
+        
+        if (player.gameLost) {
+            out += "\n💀 GAME OVER - You were caught by authorities! 💀\n";
+        }
+    }
+    
+    // Appends the same report as a JSON object
+    void appendStatsJson(string& out, const Player& player) const {
+        JsonWriter json(out);
+        json.beginObject();
+        json.key("username").text(player.username);
+        json.key("character").text(symbolName(player.characterType));
+        json.key("level").number(player.level);
+        json.key("xp").number(player.xp);
+        json.key("xpToLevel").number(player.xpToLevel);
+        json.key("credits").number(player.credits);
+        json.key("reputation").number(player.reputation);
+        json.key("heat").number(player.heat);
+        
+        json.key("skills").beginObject();
+        for (int i = 0; i < SKILL_COUNT; i++) {
+            json.key(SKILL_NAMES[i]).number(player.skills[i]);
+        }
+        json.endObject();
+        
+        json.key("equipment").beginArray();
+        for (Symbol item : player.equipment) json.text(symbolName(item));
+        json.endArray();
+        json.key("inventory").beginArray();
+        for (const InventoryStack& stack : player.inventory) {
+            json.beginObject();
+            json.key("item").text(symbolName(stack.item));
+            json.key("count").number(stack.count);
+            json.endObject();
+        }
+        json.endArray();
+        
+        json.key("missionsCompleted").number((long long)player.completedMissions.count());
+        json.key("achievements").number((long long)player.achievements.count());
+        json.key("achievementsTotal").number((long long)rules.getAchievements().size());
+        json.key("unlocked").beginArray();
+        const vector<Achievement>& achievements = rules.getAchievements();
+        for (size_t i = 0; i < achievements.size(); i++) {
+            if (player.achievements.test(i)) json.text(achievements[i].id);
+        }
+        json.endArray();
+        json.key("storyPath").text(symbolName(player.storyPath));
+        json.key("streak").number(player.missionStreak);
+        json.key("gameWon").boolean(player.gameWon);
+        json.key("gameLost").boolean(player.gameLost);
+        json.endObject();
+    }
+    
+public:
+    GameServer() : residentLimit(0), faults(0), evictions(0) {
+        snapshotIntervalSec = 60;
+        stopping = false;
+        setSeed(((uint64_t)random_device()() << 32) ^ random_device()());
+    }
+    
+    ~GameServer() {
+        {
+            lock_guard<mutex> guard(snapshotLock);
+            stopping = true;
+        }
+        snapshotWake.notify_all();
+        evictWake.notify_all();
+        if (snapshotter.joinable()) {
+            snapshotter.join();
+        }
+        if (evictor.joinable()) {
+            evictor.join();
+        }
+        journal.reset(); // flushes whatever is still buffered
+    }
+    
+    // Recover state from dir (latest snapshot plus the journal after it),
+    // then log every change there and snapshot every intervalSec seconds.
+    // Returns the number of journal entries replayed, or -1 on failure.
+    long enableJournal(const string& dir, int intervalSec = 60) {
+        if (journal) return -1;
+        
+        error_code ec;
+        filesystem::create_directories(dir, ec);
+        
+        leaderboard.loadSnapshot(dir + "/leaderboard.dat");
+        
+        vector<uint64_t> found = snapshots(dir);
+        uint64_t from = found.empty() ? 0 : found.back();
+        if (from > 0) {
+            string path = dir + "/snapshot." + to_string(from) + ".pack";
+            if (SaveFile::readPack(path, [&](Player&& player) { restorePlayer(move(player)); }) < 0) {
+                return -1;
+            }
+        }
+        
+        long replayed = Journal::replay(dir, from, [&](uint8_t, const char* body, size_t size) {
+            Player player;
+            size_t consumed = 0;
+            if (SaveFile::decode(body, size, player, consumed)) {
+                restorePlayer(move(player));
+            }
+        });
+        
+        journal.reset(new Journal(dir));
+        if (!journal->isOpen()) {
+            journal.reset();
+            return -1;
+        }
+        journalDir = dir;
+        snapshotIntervalSec = max(1, intervalSec);
+        snapshotter = thread(&GameServer::snapshotLoop, this);
+        
+        char detail[64];
+        snprintf(detail, sizeof(detail), "%s (%ld entries replayed)", dir.c_str(), replayed);
+        gameLog().log(LOG_INFO, "journal_opened", "", detail);
+        return replayed;
+    }
+    
+    // Write a snapshot of every resident player and drop the journal it covers
+    bool checkpoint() {
+        if (!journal) return false;
+        lock_guard<mutex> guard(checkpointLock);
+        
+        uint64_t segment = journal->rotate();
+        if (segment == 0) {
+            return false;
+        }
+        string tmp = journalDir + "/snapshot.tmp";
+        if (!writePack(tmp, true)) {
+            gameLog().log(LOG_ERROR, "checkpoint_failed", "", tmp.c_str());
+            return false;
+        }
+        // Players evicted since the last checkpoint are not in the snapshot;
+        // their write-backs must be on disk before the journal goes
+        if (residentLimit) {
+            saves.flush();
+            if (!store->sync()) {
+                gameLog().log(LOG_ERROR, "checkpoint_failed", "", "save store sync");
+                return false;
+            }
+        }
+        string target = journalDir + "/snapshot." + to_string(segment) + ".pack";
+        if (rename(tmp.c_str(), target.c_str()) != 0) {
+            return false;
+        }
+        int dirFd = ::open(journalDir.c_str(), O_RDONLY);
+        if (dirFd >= 0) {
+            fsync(dirFd);
+            ::close(dirFd);
+        }
+        
+        for (uint64_t older : snapshots(journalDir)) {
+            if (older < segment) {
+                string path = journalDir + "/snapshot." + to_string(older) + ".pack";
+                ::unlink(path.c_str());
+            }
+        }
+        journal->truncateBefore(segment);
+        leaderboard.saveSnapshot(journalDir + "/leaderboard.dat");
+        gameLog().log(LOG_INFO, "checkpoint_written", "", target.c_str());
+        return true;
+    }
+    
+    // Restart every thread's random sequence from seed. With one thread
+    // driving the server (the console, scripts) a seed replays a session.
+    void setSeed(uint64_t seed) {
+        rngSeed.store(seed, memory_order_relaxed);
+        rngStreams.store(0, memory_order_relaxed);
+        rngEpoch.store(nextRngEpoch.fetch_add(1), memory_order_release);
+    }
+    
+    uint64_t getSeed() const {
+        return rngSeed.load(memory_order_relaxed);
+    }
+    
+    static int64_t elapsedUs(chrono::steady_clock::time_point since) {
+        return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - since).count();
+    }
+    
+    const GameRules& getRules() const {
+        return rules;
+    }
+    
+    // Helper: Get available missions for player
+    const vector<const Mission*>& getAvailableMissions(const Player& player) const {
+        return rules.getAvailableMissions(player);
+    }
+    
+    // Helper: Find a mission open to the player by id, nullptr if there is none
+    const Mission* findMission(int missionId, const Player& player) const {
+        return rules.findMission(missionId, player);
+    }
+    
+    // Most of one loot item a player can hold; call before serving requests
+    void setInventoryCap(int cap) {
+        rules.setInventoryCap(cap);
+    }
+    
+    // Helper: Calculate heat reduction from equipment
+    int calculateHeatReduction(const Player& player) {
+        return rules.calculateHeatReduction(player);
+    }
+    
+    // Helper: Check achievements whose conditions read a field changed since
+    // the last check
+    vector<Achievement> checkAchievements(Player& player) {
+        return rules.checkAchievements(player);
+    }
+    
+    // Create player
+    string createPlayer(string username, string characterType) {
+        if (!validUsername(username)) {
+            return "ERROR: Invalid username";
+        }
+        Symbol character = EMPTY_SYMBOL;
+        if (!rules.parseCharacter(characterType, character)) {
+            return "ERROR: Unknown character";
+        }
+        {
+            auto handle = players.insert(username, rules.newPlayer(username, character));
+            if (!handle || restoreEvicted(username, handle)) {
+                return "ERROR: Player already exists";
+            }
+            recordChange(JOURNAL_CREATE, *handle);
+        }
+        noteResident();
+        
+        gameLog().log(LOG_INFO, "player_created", username, characterType.c_str());
+        return durableResult("SUCCESS: Player created");
+    }
+    
+    // Start mission
+    string startMission(string username, int missionId, int successRate) {
+        auto started = chrono::steady_clock::now();
+        return withPlayer(username, [&](Player& player) {
+            return missionFor(player, missionId, successRate, started);
+        });
+    }
+    
+    // Reduce heat (costs 300 credits)
+    string reduceHeat(string username) {
+        return withPlayer(username, [&](Player& player) { return reduceHeatFor(player); });
+    }
+    
+    // Buy item
+    string buyItem(string username, string itemId) {
+        return withPlayer(username, [&](Player& player) { return buyItemFor(player, itemId); });
+    }
+    
+    // Upgrade skill
+    string upgradeSkill(string username, string skillName) {
+        return withPlayer(username, [&](Player& player) { return upgradeSkillFor(player, skillName); });
+    }
+    
+    // Story choice
+    string storyChoice(string username, string choice) {
+        return withPlayer(username, [&](Player& player) { return storyChoiceFor(player, choice); });
+    }
+    
+    // Get player stats
+    string getPlayerStats(string username) {
+        string& out = scratchBuffer();
+        if (!renderPlayerStats(username, out)) {
+            return "ERROR: Player not found";
+        }
+        return out;
+    }
+    
+    // Append a player's stats report to out without allocating once out has
+    // grown to fit; false if the player does not exist
+    bool renderPlayerStats(const string& username, string& out) {
+        auto handle = readPlayer(username);
+        if (!handle) return false;
+        appendStats(out, *handle);
+        return true;
+    }
+    
+    bool renderPlayerStatsJson(const string& username, string& out) {
+        auto handle = readPlayer(username);
+        if (!handle) return false;
+        appendStatsJson(out, *handle);
+        return true;
+    }
+    
+    // Apply an ordered list of actions. Actions are grouped by player so each
+    // player is looked up and locked once; a player's actions run in the
+    // order given. Returns one result line per action, in input order.
+    vector<string> applyBatch(const vector<BatchAction>& actions) {
+        vector<string> results(actions.size());
+        
+        unordered_map<string, vector<size_t>> groups;
+        vector<const string*> order;
+        for (size_t i = 0; i < actions.size(); i++) {
+            vector<size_t>& group = groups[actions[i].username];
+            if (group.empty()) {
+                order.push_back(&actions[i].username);
+            }
+            group.push_back(i);
+        }
+        
+        for (const string* username : order) {
+            const vector<size_t>& group = groups[*username];
+            size_t next = 0;
+            
+            // A leading create inserts the player and keeps it locked
+            ShardedRegistry<Player>::Handle handle;
+            const BatchAction& first = actions[group[0]];
+            Symbol character = EMPTY_SYMBOL;
+            if (first.op == "create" && !validUsername(*username)) {
+                results[group[0]] = "ERROR: Invalid username";
+                next = 1;
+            } else if (first.op == "create" && !rules.parseCharacter(first.arg, character)) {
+                results[group[0]] = "ERROR: Unknown character";
+                next = 1;
+            } else if (first.op == "create") {
+                handle = players.insert(*username, rules.newPlayer(*username, character));
+                if (handle && !restoreEvicted(*username, handle)) {
+                    recordChange(JOURNAL_CREATE, *handle);
+                    gameLog().log(LOG_INFO, "player_created", *username, first.arg.c_str());
+                    results[group[0]] = "SUCCESS: Player created";
+                    noteResident();
+                } else {
+                    results[group[0]] = "ERROR: Player already exists";
+                }
+                next = 1;
+            }
+            if (!handle) {
+                handle = acquirePlayer(*username);
+            }
+            
+            for (; next < group.size(); next++) {
+                const BatchAction& action = actions[group[next]];
+                string& result = results[group[next]];
+                if (!handle) {
+                    result = "ERROR: Player not found";
+                } else if (action.op == "create") {
+                    result = "ERROR: Player already exists";
+                } else if (action.op == "mission") {
+                    result = missionFor(*handle, action.missionId, action.successRate, chrono::steady_clock::now());
+                } else if (action.op == "heat") {
+                    result = reduceHeatFor(*handle);
+                } else if (action.op == "buy") {
+                    result = buyItemFor(*handle, action.arg);
+                } else if (action.op == "upgrade") {
+                    result = upgradeSkillFor(*handle, action.arg);
+                } else if (action.op == "story") {
+                    result = storyChoiceFor(*handle, action.arg);
+                } else if (action.op == "stats") {
+                    result.clear();
+                    appendStats(result, *handle);
+                } else {
+                    result = "ERROR: Unknown action " + action.op;
+                }
+            }
+        }
+        
+        // One wait covers every change above; on failure none of them is
+        // reported as done
+        if (!finishChanges()) {
+            for (size_t i = 0; i < actions.size(); i++) {
+                if (actions[i].op != "stats" && results[i].compare(0, 6, "ERROR:") != 0) {
+                    results[i] = JOURNAL_ERROR;
+                }
+            }
+        }
+        return results;
+    }
+    
+    // Save player. Only copies the player into the save queue; the file is
+    // written in the background and done (if set) runs with the result.
+    // With the save store only the fields changed since the last
+    // successful save are written. Fields leave unsavedFields once the
+    // write succeeds, unless they changed again after it was queued or a
+    // later save was queued (it carries them too, and may yet fail); a
+    // failed save leaves them all to be written by the next one.
+    bool savePlayer(const string& username, SaveQueue::Callback done) {
+        auto handle = acquirePlayer(username);
+        if (!handle) {
+            return false;
+        }
+        
+        Player& player = *handle;
+        player.lastPlayed = time(0);
+        unsigned fields = player.unsavedFields;
+        uint32_t seq = ++player.saveSeq;
+        player.requeueFields = 0;
+        
+        saves.save(username, player, [this, username, fields, seq, done](bool ok) {
+            if (ok) {
+                auto saved = players.acquire(username);
+                if (saved && saved->saveSeq == seq) saved->unsavedFields &= ~(fields & ~saved->requeueFields);
+                gameLog().log(LOG_INFO, "player_saved", username);
+            } else {
+                gameLog().log(LOG_ERROR, "save_failed", username);
+            }
+            if (done) done(ok);
+        }, fields);
+        return true;
+    }
+    
+    // Save player and wait until the write is done; the result line says
+    // whether it reached disk
+    string savePlayerAndWait(const string& username) {
+        auto written = make_shared<promise<bool>>();
+        if (!savePlayer(username, [written](bool ok) { written->set_value(ok); })) {
+            return "ERROR: Player not found";
+        }
+        return written->get_future().get() ? "SUCCESS: Game saved!" : "ERROR: Failed to save";
+    }
+    
+    bool savePlayer(string username) {
+        return savePlayer(username, nullptr);
+    }
+    
+    // Save player and wait on the result through a future
+    future<bool> savePlayerAsync(const string& username) {
+        auto result = make_shared<promise<bool>>();
+        if (!savePlayer(username, [result](bool ok) { result->set_value(ok); })) {
+            result->set_value(false);
+        }
+        return result->get_future();
+    }
+    
+    // Keep saves in a packed store in dir instead of per-player files.
+    // Returns the number of saved players found there, or -1 on failure.
+    long enableStore(const string& dir, int compactIntervalSec = 30) {
+        if (store) return -1;
+        saves.flush();
+        unique_ptr<SaveStore> opened(new SaveStore());
+        long count = opened->open(dir, compactIntervalSec);
+        if (count < 0) return -1;
+        store = move(opened);
+        saves.setIncremental([this](const string& username) { return store->chainLength(username); });
+        
+        char detail[64];
+        snprintf(detail, sizeof(detail), "%s (%ld players)", dir.c_str(), count);
+        gameLog().log(LOG_INFO, "store_opened", "", detail);
+        return count;
+    }
+    
+    // Keep at most limit players in memory, evicting idle ones to the save
+    // store and faulting them back in on access. Needs enableStore() first;
+    // call once, before serving requests. False without a store.
+    bool limitResidentPlayers(size_t limit) {
+        if (!store || limit == 0 || residentLimit) return false;
+        residentLimit = limit;
+        evictor = thread(&GameServer::evictLoop, this);
+        
+        char detail[64];
+        snprintf(detail, sizeof(detail), "%zu players", limit);
+        gameLog().log(LOG_INFO, "resident_limit", "", detail);
+        return true;
+    }
+    
+    size_t residentPlayers() const {
+        return players.size();
+    }
+    
+    uint64_t playerFaults() const {
+        return faults.load(memory_order_relaxed);
+    }
+    
+    uint64_t playerEvictions() const {
+        return evictions.load(memory_order_relaxed);
+    }
+    
+    // Compact the save store now; returns segments removed, or -1
+    int compactStore() {
+        if (!store) return -1;
+        saves.flush();
+        return store->compact();
+    }
+    
+    // Block until every save queued so far is on disk
+    void flushSaves() {
+        saves.flush();
+    }
+    
+    // Load player, falling back to the old text save if there is no binary one
+    bool loadPlayer(string username) {
+        if (!validUsername(username)) return false;
+        saves.flush();  // read our own queued writes
+        Player player;
+        
+        bool found = store && store->read(username, player);
+        if (!found && !SaveFile::read(username + ".sav", player)) {
+            player = Player();
+            if (!SaveFile::readLegacy(username + "_save.dat", player, rules.getAchievements())) {
+                return false;
+            }
+        }
+        
+        player.username = username;
+        rules.refreshModifiers(player);
+        {
+            auto handle = players.put(username, move(player));
+            recordChange(JOURNAL_LOAD, *handle);
+        }
+        gameLog().log(LOG_INFO, "player_loaded", username);
+        noteResident();
+        return finishChanges();
+    }
+    
+    // Copy of a player's full state, e.g. for export; false if not found
+    bool exportPlayer(const string& username, Player& copy) {
+        auto handle = readPlayer(username);
+        if (!handle) return false;
+        copy = *handle;
+        return true;
+    }
+    
+    // Add or replace a player from an externally supplied state, after
+    // GameRules::validatePlayer has checked it
+    string importPlayer(Player&& player) {
+        string problem;
+        if (!rules.validatePlayer(player, problem)) {
+            return "ERROR: Bad player document: " + problem;
+        }
+        string username = player.username;
+        rules.refreshModifiers(player);
+        {
+            auto handle = players.put(username, move(player));
+            recordChange(JOURNAL_LOAD, *handle);
+        }
+        gameLog().log(LOG_INFO, "player_imported", username);
+        noteResident();
+        return durableResult("SUCCESS: Player imported!");
+    }
+    
+    // Write every player into a single pack file
+    bool savePack(const string& path) {
+        if (!writePack(path, false)) {
+            return false;
+        }
+        gameLog().log(LOG_INFO, "pack_saved", "", path.c_str());
+        return true;
+    }
+    
+    // Load every player from a pack file; returns the count or -1 on failure
+    long loadPack(const string& path) {
+        long count = SaveFile::readPack(path, [&](Player&& player) { restorePlayer(move(player)); });
+        if (count >= 0) {
+            char detail[96];
+            snprintf(detail, sizeof(detail), "%s (%ld players)", path.c_str(), count);
+            gameLog().log(LOG_INFO, "pack_loaded", "", detail);
+        }
+        return count;
+    }
+    
+    // Convert every old text save in dir to the binary format; returns the
+    // number converted
+    int convertLegacySaves(const string& dir) {
+        const string suffix = "_save.dat";
+        int converted = 0;
+        
+        error_code ec;
+        for (const auto& entry : filesystem::directory_iterator(dir, ec)) {
+            string name = entry.path().filename().string();
+            if (name.size() <= suffix.size() ||
+                name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+                continue;
+            }
+            
+            string username = name.substr(0, name.size() - suffix.size());
+            Player player;
+            if (!SaveFile::readLegacy(entry.path().string(), player, rules.getAchievements())) {
+                continue;
+            }
+            
+            filesystem::path target = filesystem::path(dir) / (username + ".sav");
+            if (SaveFile::write(target.string(), player)) {
+                converted++;
+            }
+        }
+        
+        return converted;
+    }
+    
+    // Leaderboard: top k players, or the players ranked around username
+    vector<LeaderboardEntry> getLeaderboard(size_t k) const {
+        return leaderboard.top(k);
+    }
+    
+    vector<LeaderboardEntry> getLeaderboardAround(const string& username, size_t radius) const {
+        return leaderboard.around(username, radius);
+    }
+    
+    string renderLeaderboard(const vector<LeaderboardEntry>& entries) const {
+        stringstream ss;
+        ss << "\n=== LEADERBOARD ===" << endl;
+        if (entries.empty()) {
+            ss << "No ranked players" << endl;
+        }
+        for (const auto& entry : entries) {
+            ss << "#" << entry.rank << " " << entry.username << " | Level " << entry.level
+               << " | " << entry.credits << " ¢" << endl;
+        }
+        return ss.str();
+    }
+    
+    bool saveLeaderboard(const string& path) const {
+        return leaderboard.saveSnapshot(path);
+    }
+    
+    bool loadLeaderboard(const string& path) {
+        return leaderboard.loadSnapshot(path);
+    }
+    
+    // Keep a columnar copy of the hot player fields for bulk passes. Call
+    // before serving requests; players already loaded are copied in.
+    void enableColumns() {
+        if (columns) return;
+        columns.reset(new PlayerColumns());
+        players.forEach([&](const string&, Player& player) { columns->store(player); });
+    }
+    
+    // Cool every player with heat down by amount. With columns enabled the
+    // heat column picks out who to touch, evicted players included;
+    // otherwise every resident record is scanned. Evicted players are
+    // cooled in their saved state rather than faulted in, so the pass stays
+    // within the resident budget. Returns the number of players cooled, or
+    // -1 if the journal failed.
+    int decayHeat(int amount) {
+        vector<string> candidates;
+        if (columns) {
+            candidates = columns->above(COLUMN_HEAT, 0);
+        } else {
+            players.forEach([&](const string& username, Player& player) {
+                if (player.heat > 0) candidates.push_back(username);
+            });
+        }
+        
+        int cooled = 0;
+        for (const string& username : candidates) {
+            // Retry if the player is evicted or faulted in between the checks
+            for (;;) {
+                auto handle = players.acquire(username);
+                if (handle) {
+                    if (rules.decayHeat(*handle, amount) == RULE_OK) {
+                        recordChange(JOURNAL_HEAT, *handle);
+                        cooled++;
+                    }
+                    break;
+                }
+                if (!residentLimit || players.whileAbsent(username, [&] {
+                        if (decayEvicted(username, amount)) cooled++;
+                    })) {
+                    break;
+                }
+            }
+        }
+        
+        char detail[64];
+        snprintf(detail, sizeof(detail), "%d players by %d", cooled, amount);
+        gameLog().log(LOG_INFO, "heat_decayed", "", detail);
+        return finishChanges() ? cooled : -1;
+    }
+    
+    // Up to n players with the highest value of field, best first
+    vector<pair<string, int>> topBy(ColumnField field, size_t n) {
+        if (columns) {
+            return columns->top(field, n);
+        }
+        
+        PlayerColumns scratch;
+        players.forEach([&](const string&, Player& player) { scratch.store(player); });
+        return scratch.top(field, n);
+    }
+    
+    // Mission list as a JSON array, available missions only when username
+    // names a player; each entry carries done/locked flags for that player
+    void renderMissionsJson(const string& username, string& out) {
+        auto handle = username.empty() ? ShardedRegistry<Player>::ConstHandle() : readPlayer(username);
+        const Player* player = handle ? &*handle : nullptr;
+        
+        const vector<const Mission*>& available = player ? getAvailableMissions(*player) : rules.getAllMissions();
+        
+        JsonWriter json(out);
+        json.beginArray();
+        for (const Mission* mission : available) {
+            json.beginObject();
+            json.key("id").number(mission->id);
+            json.key("name").text(mission->name);
+            json.key("reqLevel").number(mission->reqLevel);
+            json.key("type").text(mission->type);
+            json.key("heat").number(mission->heat);
+            json.key("xpReward").number(mission->xpReward);
+            json.key("creditsReward").number(mission->creditsReward);
+            if (player) {
+                json.key("done").boolean(player->completedMissions.test(mission->id));
+                json.key("locked").boolean(player->level < mission->reqLevel);
+            }
+            json.endObject();
+        }
+        json.endArray();
+    }
+    
+    // Shop catalogue as a JSON array
+    void renderShopJson(string& out) const {
+        JsonWriter json(out);
+        json.beginArray();
+        for (const ShopItem& item : rules.getShopItems()) {
+            json.beginObject();
+            json.key("id").text(symbolName(item.id));
+            json.key("name").text(item.name);
+            json.key("price").number(item.price);
+            json.key("successBonus").number(item.successBonus);
+            json.key("xpBonus").number(item.xpBonus);
+            json.key("heatReduction").number(item.heatReduction);
+            json.key("type").text(item.type);
+            json.endObject();
+        }
+        json.endArray();
+    }
+    
+    // Every achievement as a JSON array; a player's stats list the ids
+    // they have unlocked
+    void renderAchievementsJson(string& out) const {
+        JsonWriter json(out);
+        json.beginArray();
+        for (const Achievement& achievement : rules.getAchievements()) {
+            json.beginObject();
+            json.key("id").text(achievement.id);
+            json.key("name").text(achievement.name);
+            json.key("description").text(achievement.description);
+            json.key("icon").text(achievement.icon);
+            json.endObject();
+        }
+        json.endArray();
+    }
+    
+    // List all missions
+    string renderMissions(const string& username = "") {
+        auto handle = username.empty() ? ShardedRegistry<Player>::ConstHandle() : readPlayer(username);
+        const Player* player = handle ? &*handle : nullptr;
+        
+        const vector<const Mission*>& available = player ? getAvailableMissions(*player) : rules.getAllMissions();
+        
+        stringstream ss;
+        ss << "\n=== AVAILABLE MISSIONS ===" << endl;
+        for (const Mission* mission : available) {
+            ss << "[" << mission->id << "] " << mission->name;
+            ss << " | Level " << mission->reqLevel << " | ";
+            ss << mission->type << " | Heat +" << mission->heat;
+            ss << " | " << mission->xpReward << " XP | " << mission->creditsReward << " ¢";
+            
+            if (player) {
+                if (player->completedMissions.test(mission->id)) ss << " ✓ DONE";
+                else if (player->level < mission->reqLevel) ss << " 🔒 LOCKED";
+            }
+            
+            ss << endl;
+        }
+        return ss.str();
+    }
+};
+
+#endif
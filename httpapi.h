@@ -0,0 +1,436 @@
+#ifndef HTTPAPI_H
+#define HTTPAPI_H
+
+#include <string>
+#include <thread>
+
+#include "crow_all.h"
+#include "gameserver.h"
+#include "gamejson.h"
+
+using namespace std;
+
+// ============================================================================
+// HTTP API
+// ============================================================================
+//
+// JSON front-end over GameServer, served by Crow's multithreaded app. This
+// is its own API, not a port of the Express server.js routes: it speaks
+// GameServer's game (credits, heat, story paths) and the browser client in
+// game.js calls it directly.
+//
+//   POST /api/players                    {"username": "...", "character": "..."}
+//   GET  /api/players/<name>             player stats; ?format=json for fields
+//   POST /api/players/<name>/mission     {"missionId": 1, "successRate": 80}
+//   POST /api/players/<name>/heat
+//   POST /api/players/<name>/buy         {"itemId": "vpn"}
+//   POST /api/players/<name>/upgrade     {"skill": "hacking"}
+//   POST /api/players/<name>/story       {"path": "stealth"}
+//   GET  /api/players/<name>/export      full player document
+//   POST /api/players/<name>/save
+//   POST /api/players/<name>/load
+//   GET  /api/missions?player=<name>     missions, available to <name> if given
+//   GET  /api/shop                       shop items
+//   GET  /api/achievements               every achievement
+//   POST /api/batch                      {"actions": [{"op": "mission", "username": ..., ...}]}
+//   GET  /api/leaderboard?count=10       top players
+//   GET  /api/leaderboard/<name>?radius=2  players ranked around <name>
+//   PUT  /api/admin/log                  {"level": "warn", "sample": 10}
+//   POST /api/admin/players/<name>/import  {full player document}
+//
+// Usernames are 1-32 letters, digits, '_' and '-'; creating any other
+// name is refused with 400.
+//
+// Admin routes need an X-Admin-Token header matching the token the API was
+// started with, and are refused outright when it was started without one.
+//
+// Responses allow any origin (CORS) so game.js can be served from
+// elsewhere; the admin header is not allowed cross-origin.
+//
+// Every response is {"status": "success" | "fail" | "error", "message": "..."};
+// JSON stats and exports carry a "player" object instead of a message,
+// missions a "missions" list, the shop an "items" list, achievements an
+// "achievements" list, leaderboard responses an "entries" list and
+// batch responses a "results" list of {status, message} in action order.
+
+// Adds the CORS headers to every response, including Crow's automatic
+// OPTIONS preflight replies
+struct CorsHeaders {
+    struct context {};
+
+    void before_handle(crow::request&, crow::response&, context&) {}
+
+    void after_handle(crow::request&, crow::response& res, context&) {
+        res.set_header("Access-Control-Allow-Origin", "*");
+        res.set_header("Access-Control-Allow-Methods", "GET, POST, PUT, OPTIONS");
+        res.set_header("Access-Control-Allow-Headers", "Content-Type");
+    }
+};
+
+class HttpApi {
+private:
+    GameServer& server;
+    crow::App<CorsHeaders> app;
+    string adminToken;
+
+    static crow::response jsonResponse(int code, const string& body) {
+        crow::response res(code, body);
+        res.set_header("Content-Type", "application/json");
+        return res;
+    }
+
+    // Status/message replies are the hottest shape (every mission, purchase
+    // and upgrade), so they are streamed rather than built as a wvalue
+    static crow::response reply(int code, const string& status, const string& message) {
+        string& body = scratchBuffer();
+        JsonWriter json(body);
+        json.beginObject();
+        json.key("status").text(status);
+        json.key("message").text(message);
+        json.endObject();
+        return jsonResponse(code, body);
+    }
+
+    // Split a GameServer result line ("SUCCESS: ...", "FAIL: ...", "ERROR: ...")
+    // into its JSON status and message; returns the matching HTTP status
+    static int splitResult(const string& result, string& status, string& message) {
+        if (result.compare(0, 9, "SUCCESS: ") == 0) {
+            status = "success";
+            message = result.substr(9);
+            return 200;
+        }
+        if (result.compare(0, 6, "FAIL: ") == 0) {
+            status = "fail";
+            message = result.substr(6);
+            return 200;
+        }
+        if (result.compare(0, 7, "ERROR: ") == 0) {
+            status = "error";
+            message = result.substr(7);
+            return message == "Player not found" ? 404 : 400;
+        }
+        status = "success";
+        message = result;
+        return 200;
+    }
+
+    // Map a GameServer result line onto an HTTP status and JSON body
+    static crow::response reply(const string& result) {
+        string status, message;
+        int code = splitResult(result, status, message);
+        return reply(code, status, message);
+    }
+
+    static crow::response leaderboardReply(const vector<LeaderboardEntry>& entries) {
+        crow::json::wvalue body;
+        body["status"] = "success";
+        body["entries"] = vector<crow::json::wvalue>();
+        for (size_t i = 0; i < entries.size(); i++) {
+            crow::json::wvalue& entry = body["entries"][(unsigned)i];
+            entry["rank"] = entries[i].rank;
+            entry["username"] = entries[i].username;
+            entry["level"] = entries[i].level;
+            entry["credits"] = entries[i].credits;
+        }
+        return crow::response(200, body);
+    }
+
+    static int queryInt(const crow::request& req, const char* key, int fallback) {
+        const char* value = req.url_params.get(key);
+        int parsed = value ? atoi(value) : 0;
+        return parsed > 0 ? parsed : fallback;
+    }
+
+    static crow::response batchReply(const vector<string>& results) {
+        string& body = scratchBuffer();
+        JsonWriter json(body);
+        json.beginObject();
+        json.key("status").text("success");
+        json.key("results").beginArray();
+        for (const string& result : results) {
+            string status, message;
+            splitResult(result, status, message);
+            json.beginObject();
+            json.key("status").text(status);
+            json.key("message").text(message);
+            json.endObject();
+        }
+        json.endArray();
+        json.endObject();
+        return jsonResponse(200, body);
+    }
+
+    // Reads one {"op": ..., "username": ..., ...} batch entry; the argument
+    // keys match the single-action routes
+    static bool readAction(const crow::json::rvalue& entry, BatchAction& action) {
+        if (!readString(entry, "op", action.op) || !readString(entry, "username", action.username)) {
+            return false;
+        }
+        if (action.op == "mission") {
+            return readInt(entry, "missionId", action.missionId) && readInt(entry, "successRate", action.successRate);
+        }
+        if (action.op == "create") return readString(entry, "character", action.arg);
+        if (action.op == "buy") return readString(entry, "itemId", action.arg);
+        if (action.op == "upgrade") return readString(entry, "skill", action.arg);
+        if (action.op == "story") return readString(entry, "path", action.arg);
+        return action.op == "heat" || action.op == "stats";
+    }
+
+    // Second per-thread scratch string, for text rendered before it is
+    // escaped into the scratchBuffer() body
+    static string& textScratch() {
+        thread_local string text;
+        text.clear();
+        return text;
+    }
+
+    static crow::response badRequest(const string& message) {
+        return reply(400, "error", message);
+    }
+
+    // Compares the whole token whatever the first mismatch, so response
+    // times do not give it away
+    bool isAdmin(const crow::request& req) const {
+        if (adminToken.empty()) return false;
+        const string& given = req.get_header_value("X-Admin-Token");
+        unsigned char diff = given.size() != adminToken.size();
+        for (size_t i = 0; i < adminToken.size(); i++) {
+            diff |= (unsigned char)(adminToken[i] ^ (i < given.size() ? given[i] : 0));
+        }
+        return diff == 0;
+    }
+
+    static crow::response forbidden() {
+        return reply(403, "error", "Admin token required");
+    }
+
+    static bool readString(const crow::json::rvalue& body, const char* key, string& out) {
+        if (!body || !body.has(key) || body[key].t() != crow::json::type::String) {
+            return false;
+        }
+        out = body[key].s();
+        return true;
+    }
+
+    static bool readInt(const crow::json::rvalue& body, const char* key, int& out) {
+        if (!body || !body.has(key) || body[key].t() != crow::json::type::Number) {
+            return false;
+        }
+        out = (int)body[key].i();
+        return true;
+    }
+
+    void registerRoutes() {
+        CROW_ROUTE(app, "/api/players").methods("POST"_method)
+        ([this](const crow::request& req) {
+            auto body = crow::json::load(req.body);
+            string username, character;
+            if (!readString(body, "username", username) || !readString(body, "character", character)) {
+                return badRequest("Expected username and character");
+            }
+            return reply(server.createPlayer(username, character));
+        });
+
+        CROW_ROUTE(app, "/api/players/<string>").methods("GET"_method)
+        ([this](const crow::request& req, const string& username) {
+            const char* format = req.url_params.get("format");
+            bool json = format && string_view(format) == "json";
+            
+            // Rendered straight into the body, skipping the wvalue tree
+            string& body = scratchBuffer();
+            body += json ? "{\"status\":\"success\",\"player\":" : "{\"status\":\"success\",\"message\":";
+            if (json) {
+                if (!server.renderPlayerStatsJson(username, body)) return reply("ERROR: Player not found");
+            } else {
+                string& stats = textScratch();
+                if (!server.renderPlayerStats(username, stats)) return reply("ERROR: Player not found");
+                appendJsonString(body, stats);
+            }
+            body += '}';
+            return jsonResponse(200, body);
+        });
+
+        // Full player document through the json.hpp mapping; not a hot path
+        CROW_ROUTE(app, "/api/players/<string>/export").methods("GET"_method)
+        ([this](const string& username) {
+            Player player;
+            if (!server.exportPlayer(username, player)) {
+                return reply("ERROR: Player not found");
+            }
+            json body = {{"status", "success"}, {"player", player}};
+            return jsonResponse(200, body.dump());
+        });
+
+        CROW_ROUTE(app, "/api/admin/players/<string>/import").methods("POST"_method)
+        ([this](const crow::request& req, const string& username) {
+            if (!isAdmin(req)) {
+                return forbidden();
+            }
+            Player player;
+            try {
+                player = json::parse(req.body).get<Player>();
+            } catch (const exception& e) {
+                return badRequest(string("Bad player document: ") + e.what());
+            }
+            player.username = username;
+            return reply(server.importPlayer(move(player)));
+        });
+
+        CROW_ROUTE(app, "/api/missions").methods("GET"_method)
+        ([this](const crow::request& req) {
+            const char* player = req.url_params.get("player");
+            string& body = scratchBuffer();
+            body += "{\"status\":\"success\",\"missions\":";
+            server.renderMissionsJson(player ? player : "", body);
+            body += '}';
+            return jsonResponse(200, body);
+        });
+
+        CROW_ROUTE(app, "/api/shop").methods("GET"_method)
+        ([this]() {
+            string& body = scratchBuffer();
+            body += "{\"status\":\"success\",\"items\":";
+            server.renderShopJson(body);
+            body += '}';
+            return jsonResponse(200, body);
+        });
+
+        CROW_ROUTE(app, "/api/achievements").methods("GET"_method)
+        ([this]() {
+            string& body = scratchBuffer();
+            body += "{\"status\":\"success\",\"achievements\":";
+            server.renderAchievementsJson(body);
+            body += '}';
+            return jsonResponse(200, body);
+        });
+
+        CROW_ROUTE(app, "/api/players/<string>/mission").methods("POST"_method)
+        ([this](const crow::request& req, const string& username) {
+            auto body = crow::json::load(req.body);
+            int missionId, successRate;
+            if (!readInt(body, "missionId", missionId) || !readInt(body, "successRate", successRate)) {
+                return badRequest("Expected missionId and successRate");
+            }
+            return reply(server.startMission(username, missionId, successRate));
+        });
+
+        CROW_ROUTE(app, "/api/players/<string>/heat").methods("POST"_method)
+        ([this](const string& username) {
+            return reply(server.reduceHeat(username));
+        });
+
+        CROW_ROUTE(app, "/api/players/<string>/buy").methods("POST"_method)
+        ([this](const crow::request& req, const string& username) {
+            auto body = crow::json::load(req.body);
+            string itemId;
+            if (!readString(body, "itemId", itemId)) {
+                return badRequest("Expected itemId");
+            }
+            return reply(server.buyItem(username, itemId));
+        });
+
+        CROW_ROUTE(app, "/api/players/<string>/upgrade").methods("POST"_method)
+        ([this](const crow::request& req, const string& username) {
+            auto body = crow::json::load(req.body);
+            string skill;
+            if (!readString(body, "skill", skill)) {
+                return badRequest("Expected skill");
+            }
+            return reply(server.upgradeSkill(username, skill));
+        });
+
+        CROW_ROUTE(app, "/api/players/<string>/story").methods("POST"_method)
+        ([this](const crow::request& req, const string& username) {
+            auto body = crow::json::load(req.body);
+            string path;
+            if (!readString(body, "path", path)) {
+                return badRequest("Expected path");
+            }
+            return reply(server.storyChoice(username, path));
+        });
+
+        CROW_ROUTE(app, "/api/players/<string>/save").methods("POST"_method)
+        ([this](const string& username) {
+            string result = server.savePlayerAndWait(username);
+            if (result == "ERROR: Failed to save") {
+                return reply(500, "error", "Failed to save");
+            }
+            return reply(result);
+        });
+
+        CROW_ROUTE(app, "/api/players/<string>/load").methods("POST"_method)
+        ([this](const string& username) {
+            if (server.loadPlayer(username)) {
+                return reply(200, "success", "Game loaded!");
+            }
+            return reply(404, "error", "Save file not found");
+        });
+
+        CROW_ROUTE(app, "/api/batch").methods("POST"_method)
+        ([this](const crow::request& req) {
+            auto body = crow::json::load(req.body);
+            if (!body || !body.has("actions") || body["actions"].t() != crow::json::type::List) {
+                return badRequest("Expected an actions list");
+            }
+            vector<BatchAction> actions;
+            for (const auto& entry : body["actions"]) {
+                BatchAction action;
+                if (!readAction(entry, action)) {
+                    return badRequest("Bad action at index " + to_string(actions.size()));
+                }
+                actions.push_back(action);
+            }
+            return batchReply(server.applyBatch(actions));
+        });
+
+        CROW_ROUTE(app, "/api/leaderboard").methods("GET"_method)
+        ([this](const crow::request& req) {
+            return leaderboardReply(server.getLeaderboard(queryInt(req, "count", 10)));
+        });
+
+        CROW_ROUTE(app, "/api/leaderboard/<string>").methods("GET"_method)
+        ([this](const crow::request& req, const string& username) {
+            vector<LeaderboardEntry> entries = server.getLeaderboardAround(username, queryInt(req, "radius", 2));
+            if (entries.empty()) {
+                return reply(404, "error", "Player not ranked");
+            }
+            return leaderboardReply(entries);
+        });
+
+        CROW_ROUTE(app, "/api/admin/log").methods("PUT"_method)
+        ([this](const crow::request& req) {
+            if (!isAdmin(req)) {
+                return forbidden();
+            }
+            auto body = crow::json::load(req.body);
+            string levelName;
+            LogLevel level;
+            if (!readString(body, "level", levelName) || !Logger::parseLevel(levelName, level)) {
+                return badRequest("Expected level (debug/info/warn/error/off)");
+            }
+            gameLog().setLevel(level);
+            int sample;
+            if (readInt(body, "sample", sample) && sample > 0) {
+                gameLog().setSampleEvery((uint32_t)sample);
+            }
+            return reply(200, "success", "Log level set to " + levelName);
+        });
+    }
+
+public:
+    // token guards the admin routes; empty disables them
+    HttpApi(GameServer& s, const string& token = "") : server(s), adminToken(token) {
+        registerRoutes();
+        app.loglevel(crow::LogLevel::Warning);
+    }
+
+    // Blocks until the server is stopped; threads == 0 uses every core
+    void run(uint16_t port, unsigned threads = 0) {
+        if (threads == 0) {
+            threads = max(1u, thread::hardware_concurrency());
+        }
+        app.port(port).concurrency((uint16_t)threads).run();
+    }
+};
+
+#endif
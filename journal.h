@@ -0,0 +1,322 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <filesystem>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include "logger.h"
+
+using namespace std;
+
+// ============================================================================
+// WRITE-AHEAD JOURNAL
+// ============================================================================
+//
+// Append-only log of state changes, split into numbered segment files
+// (journal.<n>.wal) inside one directory. Each entry is
+//
+//   u32 length | u32 checksum | u8 op | body
+//
+// where length and checksum cover op + body. Appends go to an in-memory
+// buffer; a background thread writes the buffer out and fdatasyncs it as
+// one group every flush interval, so many appends share a single fsync.
+// A torn entry at the end of the newest segment is ignored on replay.
+//
+// A failed write, fdatasync or segment open leaves the journal failed: the
+// error is logged, the durable LSN stops advancing and every waiter, present
+// or future, is told the entry is not durable.
+
+enum JournalOp : uint8_t {
+    JOURNAL_CREATE = 1,
+    JOURNAL_MISSION,
+    JOURNAL_BUY,
+    JOURNAL_UPGRADE,
+    JOURNAL_STORY,
+    JOURNAL_HEAT,
+    JOURNAL_LOAD
+};
+
+class Journal {
+private:
+    string dir;
+    int flushIntervalMs;
+
+    mutex bufferLock;                // guards pending, appendedLsn, stopping
+    condition_variable flushNeeded;
+    string pending;
+    uint64_t appendedLsn;
+    bool stopping;
+
+    mutex ioLock;                    // guards fd and segment
+    int fd;
+    uint64_t segment;
+
+    mutex durableLock;               // guards durableLsn and failed
+    condition_variable durableChanged;
+    uint64_t durableLsn;
+    bool failed;
+
+    thread flusher;
+
+    static const size_t FLUSH_THRESHOLD = 256 * 1024;
+
+    static uint32_t checksum(const char* data, size_t size, uint32_t h = 2166136261u) {
+        for (size_t i = 0; i < size; i++) {
+            h = (h ^ (uint8_t)data[i]) * 16777619u;
+        }
+        return h;
+    }
+
+    string segmentPath(uint64_t n) const {
+        return dir + "/journal." + to_string(n) + ".wal";
+    }
+
+    bool openSegment(uint64_t n) {
+        fd = ::open(segmentPath(n).c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        segment = n;
+        return fd >= 0;
+    }
+
+    // Caller holds ioLock
+    bool writeOut(const string& data) {
+        if (fd < 0) return false;
+        size_t written = 0;
+        while (written < data.size()) {
+            ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            written += (size_t)n;
+        }
+        return fdatasync(fd) == 0;
+    }
+
+    bool hasFailed() {
+        lock_guard<mutex> guard(durableLock);
+        return failed;
+    }
+
+    void markDurable(uint64_t lsn) {
+        lock_guard<mutex> guard(durableLock);
+        if (failed) return;
+        if (lsn > durableLsn) {
+            durableLsn = lsn;
+        }
+        durableChanged.notify_all();
+    }
+
+    // Stop advancing the durable LSN and release every waiter
+    void markFailed(const char* what) {
+        int error = errno;
+        {
+            lock_guard<mutex> guard(durableLock);
+            if (failed) return;
+            failed = true;
+        }
+        durableChanged.notify_all();
+        char detail[128];
+        snprintf(detail, sizeof(detail), "%s on segment %llu: %s", what,
+                 (unsigned long long)segment, strerror(error));
+        gameLog().log(LOG_ERROR, "journal_failed", "", detail);
+    }
+
+    // Caller holds ioLock. Writes batch and marks everything up to lsn
+    // durable; once failed, batches are dropped since nothing after a torn
+    // entry would be replayed anyway.
+    void commit(const string& batch, uint64_t lsn) {
+        if (hasFailed()) return;
+        if (!batch.empty() && !writeOut(batch)) {
+            markFailed("write failed");
+            return;
+        }
+        markDurable(lsn);
+    }
+
+    // Moves the pending buffer to disk; returns false once stopped and drained
+    bool flushOnce(bool wait) {
+        if (wait) {
+            unique_lock<mutex> guard(bufferLock);
+            flushNeeded.wait_for(guard, chrono::milliseconds(flushIntervalMs), [this] {
+                return stopping || pending.size() >= FLUSH_THRESHOLD;
+            });
+        }
+
+        lock_guard<mutex> io(ioLock);
+        string batch;
+        uint64_t lsn;
+        bool done;
+        {
+            lock_guard<mutex> guard(bufferLock);
+            batch.swap(pending);
+            lsn = appendedLsn;
+            done = stopping;
+        }
+        commit(batch, lsn);
+        return !done;
+    }
+
+    void flushLoop() {
+        while (flushOnce(true)) {
+        }
+    }
+
+public:
+    // Opens a new segment after the highest one already in dir
+    Journal(const string& d, int intervalMs = 5)
+        : dir(d), flushIntervalMs(intervalMs), appendedLsn(0), stopping(false),
+          fd(-1), segment(0), durableLsn(0), failed(false) {
+        filesystem::create_directories(dir);
+        openSegment(lastSegment(dir) + 1);
+        if (fd < 0) failed = true;
+        flusher = thread(&Journal::flushLoop, this);
+    }
+
+    ~Journal() {
+        {
+            lock_guard<mutex> guard(bufferLock);
+            stopping = true;
+        }
+        flushNeeded.notify_one();
+        flusher.join();
+        if (fd >= 0) ::close(fd);
+    }
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    bool isOpen() const { return fd >= 0; }
+
+    // Queues one entry and returns its log sequence number
+    uint64_t append(uint8_t op, const string& body) {
+        uint32_t length = (uint32_t)(body.size() + 1);
+        char header[9];
+        memcpy(header, &length, 4);
+        header[8] = (char)op;
+        uint32_t sum = checksum(body.data(), body.size(), checksum(header + 8, 1));
+        memcpy(header + 4, &sum, 4);
+
+        lock_guard<mutex> guard(bufferLock);
+        pending.append(header, sizeof(header));
+        pending.append(body);
+        if (pending.size() >= FLUSH_THRESHOLD) {
+            flushNeeded.notify_one();
+        }
+        return ++appendedLsn;
+    }
+
+    // Blocks until every entry up to lsn has been fsynced. False if the
+    // journal failed first: the entry may not survive a crash.
+    bool waitDurable(uint64_t lsn) {
+        unique_lock<mutex> guard(durableLock);
+        durableChanged.wait(guard, [&] { return durableLsn >= lsn || failed; });
+        return durableLsn >= lsn;
+    }
+
+    // Flushes what is buffered, closes the current segment and starts the
+    // next one. Returns the new segment number: everything appended from now
+    // on lands in it or later segments. Returns 0 if the journal has failed.
+    uint64_t rotate() {
+        lock_guard<mutex> io(ioLock);
+        string batch;
+        uint64_t lsn;
+        {
+            lock_guard<mutex> guard(bufferLock);
+            batch.swap(pending);
+            lsn = appendedLsn;
+        }
+        commit(batch, lsn);
+        if (hasFailed()) return 0;
+
+        if (fd >= 0) ::close(fd);
+        if (!openSegment(segment + 1)) {
+            markFailed("open failed");
+            return 0;
+        }
+        return segment;
+    }
+
+    // Deletes segments numbered below n
+    void truncateBefore(uint64_t n) {
+        for (uint64_t s : segments(dir)) {
+            if (s < n) {
+                ::unlink(segmentPath(s).c_str());
+            }
+        }
+    }
+
+    // Segment numbers present in dir, ascending
+    static vector<uint64_t> segments(const string& dir) {
+        vector<uint64_t> found;
+        error_code ec;
+        for (const auto& entry : filesystem::directory_iterator(dir, ec)) {
+            string name = entry.path().filename().string();
+            if (name.compare(0, 8, "journal.") != 0 || name.size() <= 12 ||
+                name.compare(name.size() - 4, 4, ".wal") != 0) {
+                continue;
+            }
+            found.push_back(strtoull(name.c_str() + 8, nullptr, 10));
+        }
+        sort(found.begin(), found.end());
+        return found;
+    }
+
+    static uint64_t lastSegment(const string& dir) {
+        vector<uint64_t> found = segments(dir);
+        return found.empty() ? 0 : found.back();
+    }
+
+    // Feeds every intact entry in segments numbered from `from` onwards to
+    // sink, oldest first. Returns the number of entries replayed.
+    static long replay(const string& dir, uint64_t from,
+                       const function<void(uint8_t op, const char* body, size_t size)>& sink) {
+        long count = 0;
+        for (uint64_t s : segments(dir)) {
+            if (s < from) continue;
+
+            string path = dir + "/journal." + to_string(s) + ".wal";
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) continue;
+
+            struct stat st;
+            if (fstat(fd, &st) != 0 || st.st_size == 0) {
+                ::close(fd);
+                continue;
+            }
+            size_t size = (size_t)st.st_size;
+            void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (mapped == MAP_FAILED) continue;
+
+            const char* data = (const char*)mapped;
+            size_t offset = 0;
+            while (size - offset >= 9) {
+                uint32_t length, sum;
+                memcpy(&length, data + offset, 4);
+                memcpy(&sum, data + offset + 4, 4);
+                if (length == 0 || size - offset - 8 < length) break;
+                const char* entry = data + offset + 8;
+                if (checksum(entry, length) != sum) break;
+
+                sink((uint8_t)entry[0], entry + 1, length - 1);
+                count++;
+                offset += 8 + length;
+            }
+            munmap(mapped, size);
+        }
+        return count;
+    }
+};
+
+#endif
@@ -1,6 +1,163 @@
 #include "leaderboard.h"
 #include <fstream>
 #include <sstream>
+#include <mutex>
+#include <cstdint>
+#include <cstdio>
 using namespace std;
-void Leaderboard::update(Player& p){ ofstream f("leaderboard.txt",ios::app); f<<p.name<<" "<<p.level<<"\n"; f.close(); }
-string Leaderboard::fetch(){ ifstream f("leaderboard.txt"); string n; int l; stringstream ss; while(f>>n>>l) ss<<n<<" (Lvl "<<l<<")\n"; return ss.str(); }
\ No newline at end of file
+
+static const uint32_t SNAPSHOT_MAGIC = 0x424c5448; // "HTLB"
+
+void Leaderboard::update(const string& username, int level, int credits) {
+    {
+        shared_lock<shared_mutex> guard(lock);
+        auto it = scores.find(username);
+        if (it != scores.end() && it->second.first == level && it->second.second == credits) return;
+    }
+    unique_lock<shared_mutex> guard(lock);
+    place(username, level, credits);
+}
+
+void Leaderboard::place(const string& username, int level, int credits) {
+    auto it = scores.find(username);
+    if (it != scores.end()) {
+        if (it->second.first == level && it->second.second == credits) return;
+        tree.erase(Key(-it->second.first, -it->second.second, username));
+        it->second = make_pair(level, credits);
+    } else {
+        scores.emplace(username, make_pair(level, credits));
+    }
+    tree.insert(Key(-level, -credits, username));
+}
+
+void Leaderboard::queueUpdate(const string& username, int level, int credits) {
+    QueueStripe& stripe = queue[hash<string>()(username) % QUEUE_STRIPES];
+    lock_guard<mutex> guard(stripe.lock);
+    stripe.scores[username] = make_pair(level, credits);
+    stripe.updates++;
+    queued.fetch_add(1, memory_order_release);
+}
+
+// Stripes are swapped out only under the exclusive lock, so queued scores
+// for one player reach the tree in the order they were queued. The counter
+// drops only once a batch is in the tree: seeing 0 means nothing queued
+// earlier is still in flight.
+void Leaderboard::applyQueued() {
+    if (queued.load(memory_order_acquire) == 0) return;
+    unique_lock<shared_mutex> guard(lock);
+    size_t applied = 0;
+    for (QueueStripe& stripe : queue) {
+        unordered_map<string, pair<int, int>> batch;
+        {
+            lock_guard<mutex> stripeGuard(stripe.lock);
+            if (stripe.updates == 0) continue;
+            batch.swap(stripe.scores);
+            applied += stripe.updates;
+            stripe.updates = 0;
+        }
+        for (const auto& entry : batch) {
+            place(entry.first, entry.second.first, entry.second.second);
+        }
+    }
+    queued.fetch_sub(applied, memory_order_release);
+}
+
+void Leaderboard::remove(const string& username) {
+    unique_lock<shared_mutex> guard(lock);
+    auto it = scores.find(username);
+    if (it == scores.end()) return;
+    tree.erase(Key(-it->second.first, -it->second.second, username));
+    scores.erase(it);
+}
+
+int Leaderboard::rank(const string& username) const {
+    shared_lock<shared_mutex> guard(lock);
+    auto it = scores.find(username);
+    if (it == scores.end()) return 0;
+    return (int)tree.order_of_key(Key(-it->second.first, -it->second.second, username)) + 1;
+}
+
+// Caller holds lock
+vector<LeaderboardEntry> Leaderboard::range(size_t first, size_t count) const {
+    vector<LeaderboardEntry> entries;
+    if (first >= tree.size()) return entries;
+    entries.reserve(min(count, tree.size() - first));
+    auto it = tree.find_by_order(first);
+    for (size_t i = 0; i < count && it != tree.end(); i++, ++it) {
+        entries.push_back({get<2>(*it), -get<0>(*it), -get<1>(*it), (int)(first + i + 1)});
+    }
+    return entries;
+}
+
+vector<LeaderboardEntry> Leaderboard::top(size_t k) const {
+    shared_lock<shared_mutex> guard(lock);
+    return range(0, k);
+}
+
+vector<LeaderboardEntry> Leaderboard::around(const string& username, size_t radius) const {
+    shared_lock<shared_mutex> guard(lock);
+    auto it = scores.find(username);
+    if (it == scores.end()) return vector<LeaderboardEntry>();
+    size_t position = tree.order_of_key(Key(-it->second.first, -it->second.second, username));
+    size_t first = position > radius ? position - radius : 0;
+    return range(first, position - first + radius + 1);
+}
+
+size_t Leaderboard::size() const {
+    shared_lock<shared_mutex> guard(lock);
+    return tree.size();
+}
+
+string Leaderboard::fetch(size_t k) const {
+    stringstream ss;
+    for (const auto& entry : top(k)) ss << entry.username << " (Lvl " << entry.level << ")\n";
+    return ss.str();
+}
+
+// Snapshot layout: u32 magic | u32 count | count x (u16 name length | name | i32 level | i32 credits)
+bool Leaderboard::saveSnapshot(const string& path) const {
+    string buffer;
+    {
+        shared_lock<shared_mutex> guard(lock);
+        uint32_t magic = SNAPSHOT_MAGIC, count = (uint32_t)tree.size();
+        buffer.append((const char*)&magic, 4);
+        buffer.append((const char*)&count, 4);
+        for (const Key& key : tree) {
+            const string& name = get<2>(key);
+            uint16_t length = (uint16_t)min(name.size(), (size_t)UINT16_MAX);
+            int32_t level = -get<0>(key), credits = -get<1>(key);
+            buffer.append((const char*)&length, 2);
+            buffer.append(name.data(), length);
+            buffer.append((const char*)&level, 4);
+            buffer.append((const char*)&credits, 4);
+        }
+    }
+    string tmp = path + ".tmp";
+    ofstream f(tmp, ios::binary | ios::trunc);
+    if (!f.is_open()) return false;
+    f.write(buffer.data(), buffer.size());
+    f.close();
+    if (!f) return false;
+    return rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+bool Leaderboard::loadSnapshot(const string& path) {
+    ifstream f(path, ios::binary);
+    if (!f.is_open()) return false;
+    uint32_t magic = 0, count = 0;
+    f.read((char*)&magic, 4);
+    f.read((char*)&count, 4);
+    if (!f || magic != SNAPSHOT_MAGIC) return false;
+    for (uint32_t i = 0; i < count; i++) {
+        uint16_t length = 0;
+        int32_t level = 0, credits = 0;
+        f.read((char*)&length, 2);
+        string name(length, '\0');
+        f.read(&name[0], length);
+        f.read((char*)&level, 4);
+        f.read((char*)&credits, 4);
+        if (!f) return false;
+        update(name, level, credits);
+    }
+    return true;
+}
@@ -1,9 +1,71 @@
 #ifndef LEADERBOARD_H
 #define LEADERBOARD_H
-#include "Player.h"
-class Leaderboard{
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+#include <atomic>
+#include <tuple>
+#include <ext/pb_ds/assoc_container.hpp>
+#include <ext/pb_ds/tree_policy.hpp>
+using namespace std;
+
+// In-memory ranked leaderboard ordered by level, then credits (both highest
+// first), then username. Updates and rank lookups are O(log n) on an
+// order-statistics tree; top-K and "around me" queries walk at most K entries.
+// Callers holding other locks can queue an update instead: queueing takes only
+// a striped mutex, and applyQueued() later moves everything queued into the
+// tree under one exclusive lock.
+struct LeaderboardEntry {
+    string username;
+    int level;
+    int credits;
+    int rank; // 1-based
+};
+
+class Leaderboard {
 public:
-void update(Player&);
-string fetch();
+    // Inserts or repositions a player; no-op if level and credits are unchanged
+    void update(const string& username, int level, int credits);
+    // As update(), but only recorded until the next applyQueued(); a later
+    // queued score for the same player replaces an earlier one
+    void queueUpdate(const string& username, int level, int credits);
+    // Applies every update queued before the call, including those another
+    // thread is applying at the same time, before returning
+    void applyQueued();
+    void remove(const string& username);
+    // 0 if the player is not ranked
+    int rank(const string& username) const;
+    vector<LeaderboardEntry> top(size_t k) const;
+    // The player plus up to radius entries on either side
+    vector<LeaderboardEntry> around(const string& username, size_t radius) const;
+    size_t size() const;
+    // Top-K as text, one "name (Lvl n)" line per player
+    string fetch(size_t k = 10) const;
+    // Compact binary snapshot of every ranked player
+    bool saveSnapshot(const string& path) const;
+    bool loadSnapshot(const string& path);
+private:
+    // (-level, -credits, username) so the natural order is best first
+    typedef tuple<int, int, string> Key;
+    typedef __gnu_pbds::tree<Key, __gnu_pbds::null_type, less<Key>, __gnu_pbds::rb_tree_tag,
+                             __gnu_pbds::tree_order_statistics_node_update> RankTree;
+    RankTree tree;
+    unordered_map<string, pair<int, int>> scores; // username -> (level, credits)
+    mutable shared_mutex lock;
+
+    static const size_t QUEUE_STRIPES = 64;
+    struct QueueStripe {
+        mutex lock;
+        unordered_map<string, pair<int, int>> scores;
+        size_t updates = 0;
+    };
+    QueueStripe queue[QUEUE_STRIPES];
+    atomic<size_t> queued{0};    // updates queued and not yet in the tree
+
+    vector<LeaderboardEntry> range(size_t first, size_t count) const;
+    // Caller holds lock exclusively
+    void place(const string& username, int level, int credits);
 };
-#endif
\ No newline at end of file
+#endif
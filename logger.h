@@ -0,0 +1,293 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <string>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+
+using namespace std;
+
+// ============================================================================
+// LOGGER
+// ============================================================================
+//
+// Asynchronous structured logger. Request threads copy a fixed-size record
+// into a lock-free ring buffer and return; a background thread drains the
+// ring, formats records as key=value lines and writes them in batches. When
+// the ring is full records are dropped and counted rather than blocking the
+// caller. Level and sampling can be changed at any time.
+
+enum LogLevel {
+    LOG_DEBUG = 0,
+    LOG_INFO,
+    LOG_WARN,
+    LOG_ERROR,
+    LOG_OFF
+};
+
+struct LogRecord {
+    int64_t timeUs;
+    LogLevel level;
+    const char* event;     // string literal
+    int missionId;         // -1 when not set
+    int heat;              // -1 when not set
+    int64_t latencyUs;     // -1 when not set
+    char user[32];
+    char detail[96];
+};
+
+class Logger {
+private:
+    static const size_t CAPACITY = 8192; // power of two
+
+    struct Slot {
+        atomic<size_t> sequence;
+        LogRecord record;
+    };
+
+    unique_ptr<Slot[]> slots;
+    alignas(64) atomic<size_t> enqueuePos;
+    alignas(64) size_t dequeuePos;
+
+    atomic<int> minLevel;
+    atomic<uint32_t> sampleEvery;
+    atomic<uint64_t> dropped;
+    atomic<bool> stopping;
+
+    mutex outputLock;
+    FILE* output;
+    bool ownsOutput;
+
+    thread drainer;
+
+    static void copyField(char* dest, size_t size, const char* src) {
+        size_t n = strlen(src);
+        if (n >= size) n = size - 1;
+        memcpy(dest, src, n);
+        dest[n] = '\0';
+    }
+
+    bool tryPush(const LogRecord& record) {
+        size_t pos = enqueuePos.load(memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots[pos & (CAPACITY - 1)];
+            size_t seq = slot.sequence.load(memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                    slot.record = record;
+                    slot.sequence.store(pos + 1, memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos.load(memory_order_relaxed);
+            }
+        }
+    }
+
+    // Only called from the drain thread
+    bool tryPop(LogRecord& record) {
+        Slot& slot = slots[dequeuePos & (CAPACITY - 1)];
+        size_t seq = slot.sequence.load(memory_order_acquire);
+        if ((intptr_t)seq - (intptr_t)(dequeuePos + 1) < 0) {
+            return false;
+        }
+        record = slot.record;
+        slot.sequence.store(dequeuePos + CAPACITY, memory_order_release);
+        dequeuePos++;
+        return true;
+    }
+
+    static const char* levelName(LogLevel level) {
+        switch (level) {
+            case LOG_DEBUG: return "debug";
+            case LOG_INFO: return "info";
+            case LOG_WARN: return "warn";
+            case LOG_ERROR: return "error";
+            default: return "off";
+        }
+    }
+
+    // Appends text as a double-quoted value. Quotes, backslashes and control
+    // characters are escaped, so client-supplied names cannot end the field
+    // early or start a forged line.
+    static void appendQuoted(string& out, const char* text) {
+        out.push_back('"');
+        for (const char* p = text; *p; p++) {
+            unsigned char c = (unsigned char)*p;
+            if (c == '"' || c == '\\') {
+                out.push_back('\\');
+                out.push_back((char)c);
+            } else if (c == '\n') {
+                out.append("\\n");
+            } else if (c == '\r') {
+                out.append("\\r");
+            } else if (c == '\t') {
+                out.append("\\t");
+            } else if (c < 0x20 || c == 0x7f) {
+                char escaped[5];
+                snprintf(escaped, sizeof(escaped), "\\x%02x", c);
+                out.append(escaped, 4);
+            } else {
+                out.push_back((char)c);
+            }
+        }
+        out.push_back('"');
+    }
+
+    static void format(const LogRecord& r, string& out) {
+        char line[320];
+        int n = snprintf(line, sizeof(line), "ts=%lld.%06lld level=%s event=%s",
+                         (long long)(r.timeUs / 1000000), (long long)(r.timeUs % 1000000),
+                         levelName(r.level), r.event);
+        out.append(line, min((size_t)n, sizeof(line) - 1));
+        if (r.user[0]) {
+            out.append(" user=");
+            appendQuoted(out, r.user);
+        }
+        if (r.missionId >= 0) {
+            n = snprintf(line, sizeof(line), " mission=%d", r.missionId);
+            out.append(line, n);
+        }
+        if (r.heat >= 0) {
+            n = snprintf(line, sizeof(line), " heat=%d", r.heat);
+            out.append(line, n);
+        }
+        if (r.latencyUs >= 0) {
+            n = snprintf(line, sizeof(line), " latency_us=%lld", (long long)r.latencyUs);
+            out.append(line, n);
+        }
+        if (r.detail[0]) {
+            out.append(" msg=");
+            appendQuoted(out, r.detail);
+        }
+        out.push_back('\n');
+    }
+
+    void drainLoop() {
+        string batch;
+        uint64_t reportedDrops = 0;
+        LogRecord record;
+        for (;;) {
+            bool stop = stopping.load(memory_order_acquire);
+            while (tryPop(record)) {
+                format(record, batch);
+            }
+
+            uint64_t drops = dropped.load(memory_order_relaxed);
+            if (drops != reportedDrops) {
+                char line[96];
+                int n = snprintf(line, sizeof(line), "level=warn event=log_dropped count=%llu\n",
+                                 (unsigned long long)(drops - reportedDrops));
+                batch.append(line, n);
+                reportedDrops = drops;
+            }
+
+            if (!batch.empty()) {
+                lock_guard<mutex> guard(outputLock);
+                fwrite(batch.data(), 1, batch.size(), output);
+                fflush(output);
+                batch.clear();
+            }
+
+            if (stop) break;
+            this_thread::sleep_for(chrono::milliseconds(2));
+        }
+    }
+
+public:
+    Logger()
+        : slots(new Slot[CAPACITY]), enqueuePos(0), dequeuePos(0), minLevel(LOG_INFO),
+          sampleEvery(1), dropped(0), stopping(false), output(stderr), ownsOutput(false) {
+        for (size_t i = 0; i < CAPACITY; i++) {
+            slots[i].sequence.store(i, memory_order_relaxed);
+        }
+        drainer = thread(&Logger::drainLoop, this);
+    }
+
+    ~Logger() {
+        stopping.store(true, memory_order_release);
+        drainer.join();
+        if (ownsOutput) fclose(output);
+    }
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    bool enabled(LogLevel level) const {
+        return (int)level >= minLevel.load(memory_order_relaxed);
+    }
+
+    void setLevel(LogLevel level) { minLevel.store(level, memory_order_relaxed); }
+
+    // Keep one in every n info/debug records; warnings and errors are
+    // never sampled out
+    void setSampleEvery(uint32_t n) { sampleEvery.store(n == 0 ? 1 : n, memory_order_relaxed); }
+
+    uint64_t droppedCount() const { return dropped.load(memory_order_relaxed); }
+
+    // Appends to path instead of stderr
+    bool setOutputFile(const string& path) {
+        FILE* file = fopen(path.c_str(), "a");
+        if (!file) return false;
+        lock_guard<mutex> guard(outputLock);
+        if (ownsOutput) fclose(output);
+        output = file;
+        ownsOutput = true;
+        return true;
+    }
+
+    static bool parseLevel(const string& name, LogLevel& level) {
+        if (name == "debug") level = LOG_DEBUG;
+        else if (name == "info") level = LOG_INFO;
+        else if (name == "warn") level = LOG_WARN;
+        else if (name == "error") level = LOG_ERROR;
+        else if (name == "off") level = LOG_OFF;
+        else return false;
+        return true;
+    }
+
+    void log(LogLevel level, const char* event, const string& user, const char* detail = "",
+             int missionId = -1, int heat = -1, int64_t latencyUs = -1) {
+        if (!enabled(level)) return;
+
+        if (level < LOG_WARN) {
+            uint32_t every = sampleEvery.load(memory_order_relaxed);
+            if (every > 1) {
+                static thread_local uint32_t tick = 0;
+                if (++tick % every != 0) return;
+            }
+        }
+
+        LogRecord record;
+        record.timeUs = chrono::duration_cast<chrono::microseconds>(
+            chrono::system_clock::now().time_since_epoch()).count();
+        record.level = level;
+        record.event = event;
+        record.missionId = missionId;
+        record.heat = heat;
+        record.latencyUs = latencyUs;
+        copyField(record.user, sizeof(record.user), user.c_str());
+        copyField(record.detail, sizeof(record.detail), detail);
+
+        if (!tryPush(record)) {
+            dropped.fetch_add(1, memory_order_relaxed);
+        }
+    }
+};
+
+// Process-wide logger used by the game server
+inline Logger& gameLog() {
+    static Logger logger;
+    return logger;
+}
+
+#endif
@@ -0,0 +1,170 @@
+#ifndef PLAYERCOLUMNS_H
+#define PLAYERCOLUMNS_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+#include <algorithm>
+#include <cstdint>
+
+#include "gamedata.h"
+
+using namespace std;
+
+// ============================================================================
+// PLAYER COLUMNS
+// ============================================================================
+//
+// Columnar copy of the hot numeric player fields. Each player gets a dense
+// id on first sight; every field is a contiguous int array indexed by that
+// id and the username is kept out of line, so a pass over one field for
+// millions of players reads nothing else and the compiler can vectorize it.
+//
+// Locking is inverted on purpose: a player's row is only ever written by the
+// thread holding that player's registry handle, so row updates from
+// different threads never touch the same element and share the lock. Bulk
+// scans and new rows take it exclusively.
+
+enum ColumnField {
+    COLUMN_LEVEL,
+    COLUMN_XP,
+    COLUMN_CREDITS,
+    COLUMN_REPUTATION,
+    COLUMN_HEAT,
+    COLUMN_COUNT
+};
+
+struct ColumnSummary {
+    size_t count;
+    int64_t sum;
+    int min;
+    int max;
+};
+
+class PlayerColumns {
+private:
+    mutable shared_mutex lock;
+    unordered_map<string, uint32_t> ids;
+    vector<string> usernames;              // id -> username
+    vector<int32_t> columns[COLUMN_COUNT];
+
+    static const size_t BLOCK = 64;
+
+    void write(uint32_t id, const Player& player) {
+        columns[COLUMN_LEVEL][id] = player.level;
+        columns[COLUMN_XP][id] = player.xp;
+        columns[COLUMN_CREDITS][id] = player.credits;
+        columns[COLUMN_REPUTATION][id] = player.reputation;
+        columns[COLUMN_HEAT][id] = player.heat;
+    }
+
+public:
+    // Copies the player's hot fields into their row, adding the row if new
+    void store(const Player& player) {
+        {
+            shared_lock<shared_mutex> guard(lock);
+            auto it = ids.find(player.username);
+            if (it != ids.end()) {
+                write(it->second, player);
+                return;
+            }
+        }
+
+        unique_lock<shared_mutex> guard(lock);
+        auto result = ids.emplace(player.username, (uint32_t)usernames.size());
+        if (result.second) {
+            usernames.push_back(player.username);
+            for (auto& column : columns) {
+                column.push_back(0);
+            }
+        }
+        write(result.first->second, player);
+    }
+
+    size_t size() const {
+        shared_lock<shared_mutex> guard(lock);
+        return usernames.size();
+    }
+
+    // Usernames of every player whose field is above threshold
+    vector<string> above(ColumnField field, int threshold) const {
+        unique_lock<shared_mutex> guard(lock);
+        const int32_t* values = columns[field].data();
+        size_t count = columns[field].size();
+        vector<string> found;
+
+        // Test a block at a time with a branch-free reduction so blocks with
+        // no match are skipped at vector speed
+        for (size_t start = 0; start < count; start += BLOCK) {
+            size_t end = min(count, start + BLOCK);
+            int hits = 0;
+            for (size_t i = start; i < end; i++) {
+                hits |= values[i] > threshold;
+            }
+            if (!hits) continue;
+            for (size_t i = start; i < end; i++) {
+                if (values[i] > threshold) {
+                    found.push_back(usernames[i]);
+                }
+            }
+        }
+        return found;
+    }
+
+    // Up to n (username, value) pairs with the highest values of field
+    vector<pair<string, int>> top(ColumnField field, size_t n) const {
+        unique_lock<shared_mutex> guard(lock);
+        const vector<int32_t>& values = columns[field];
+        vector<uint32_t> order(values.size());
+        for (uint32_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+
+        n = min(n, order.size());
+        auto higher = [&](uint32_t a, uint32_t b) {
+            return values[a] != values[b] ? values[a] > values[b] : usernames[a] < usernames[b];
+        };
+        partial_sort(order.begin(), order.begin() + n, order.end(), higher);
+
+        vector<pair<string, int>> result;
+        for (size_t i = 0; i < n; i++) {
+            result.emplace_back(usernames[order[i]], values[order[i]]);
+        }
+        return result;
+    }
+
+    ColumnSummary summarize(ColumnField field) const {
+        unique_lock<shared_mutex> guard(lock);
+        const int32_t* values = columns[field].data();
+        size_t count = columns[field].size();
+
+        ColumnSummary summary = {count, 0, 0, 0};
+        if (count == 0) return summary;
+
+        int64_t sum = 0;
+        int lo = values[0], hi = values[0];
+        for (size_t i = 0; i < count; i++) {
+            sum += values[i];
+            lo = min(lo, (int)values[i]);
+            hi = max(hi, (int)values[i]);
+        }
+        summary.sum = sum;
+        summary.min = lo;
+        summary.max = hi;
+        return summary;
+    }
+
+    static bool parseField(const string& name, ColumnField& field) {
+        if (name == "level") field = COLUMN_LEVEL;
+        else if (name == "xp") field = COLUMN_XP;
+        else if (name == "credits") field = COLUMN_CREDITS;
+        else if (name == "reputation") field = COLUMN_REPUTATION;
+        else if (name == "heat") field = COLUMN_HEAT;
+        else return false;
+        return true;
+    }
+};
+
+#endif
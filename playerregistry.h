@@ -0,0 +1,216 @@
+#ifndef PLAYERREGISTRY_H
+#define PLAYERREGISTRY_H
+
+#include <string>
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+#include <functional>
+#include <atomic>
+#include <vector>
+
+using namespace std;
+
+// ============================================================================
+// PLAYER REGISTRY
+// ============================================================================
+//
+// Concurrent username -> Player table. Players are spread over a fixed number
+// of shards by hash, each with its own lock, so calls for players on different
+// shards never contend. Every access is a single hash lookup that hands back
+// a handle holding the shard lock for as long as the caller keeps it.
+//
+// Entries carry a CLOCK reference bit, set on every access, and a dirty bit,
+// set whenever exclusive access is handed out. evict() uses them to drop
+// idle entries when the registry is used as a bounded cache.
+
+template <typename T>
+class ShardedRegistry {
+private:
+    static const size_t SHARD_COUNT = 64; // power of two
+
+    struct Entry {
+        T value;
+        mutable atomic<bool> referenced;
+        bool dirty;
+
+        Entry() : referenced(true), dirty(true) {}
+        Entry(T&& v, bool d) : value(move(v)), referenced(true), dirty(d) {}
+    };
+
+    struct alignas(64) Shard {
+        mutable shared_mutex lock;
+        unordered_map<string, Entry> entries;
+        size_t hand = 0;  // next bucket the eviction sweep looks at
+    };
+
+    Shard shards[SHARD_COUNT];
+    atomic<size_t> count{0};
+
+    Shard& shardFor(const string& key) {
+        return shards[hash<string>()(key) & (SHARD_COUNT - 1)];
+    }
+
+public:
+    // Exclusive access to one entry; empty if the key was not found
+    class Handle {
+    private:
+        unique_lock<shared_mutex> guard;
+        T* entry;
+
+    public:
+        Handle() : entry(nullptr) {}
+        Handle(unique_lock<shared_mutex>&& g, T* e) : guard(move(g)), entry(e) {}
+
+        explicit operator bool() const { return entry != nullptr; }
+        T& operator*() const { return *entry; }
+        T* operator->() const { return entry; }
+    };
+
+    // Shared access to one entry for read-only callers
+    class ConstHandle {
+    private:
+        shared_lock<shared_mutex> guard;
+        const T* entry;
+
+    public:
+        ConstHandle() : entry(nullptr) {}
+        ConstHandle(shared_lock<shared_mutex>&& g, const T* e) : guard(move(g)), entry(e) {}
+
+        explicit operator bool() const { return entry != nullptr; }
+        const T& operator*() const { return *entry; }
+        const T* operator->() const { return entry; }
+    };
+
+    Handle acquire(const string& key) {
+        Shard& shard = shardFor(key);
+        unique_lock<shared_mutex> guard(shard.lock);
+        auto it = shard.entries.find(key);
+        if (it == shard.entries.end()) {
+            return Handle();
+        }
+        it->second.referenced.store(true, memory_order_relaxed);
+        it->second.dirty = true;
+        return Handle(move(guard), &it->second.value);
+    }
+
+    ConstHandle read(const string& key) {
+        Shard& shard = shardFor(key);
+        shared_lock<shared_mutex> guard(shard.lock);
+        auto it = shard.entries.find(key);
+        if (it == shard.entries.end()) {
+            return ConstHandle();
+        }
+        it->second.referenced.store(true, memory_order_relaxed);
+        return ConstHandle(move(guard), &it->second.value);
+    }
+
+    // Adds a new entry and returns it still locked; returns an empty handle
+    // and leaves the table untouched if the key already exists. Pass
+    // dirty = false for a value that is already persisted as is.
+    Handle insert(const string& key, T&& value, bool dirty = true) {
+        Shard& shard = shardFor(key);
+        unique_lock<shared_mutex> guard(shard.lock);
+        auto result = shard.entries.try_emplace(key, move(value), dirty);
+        if (!result.second) {
+            return Handle();
+        }
+        count.fetch_add(1, memory_order_relaxed);
+        return Handle(move(guard), &result.first->second.value);
+    }
+
+    // Adds or replaces an entry and returns it still locked
+    Handle put(const string& key, T&& value) {
+        Shard& shard = shardFor(key);
+        unique_lock<shared_mutex> guard(shard.lock);
+        auto result = shard.entries.try_emplace(key);
+        if (result.second) count.fetch_add(1, memory_order_relaxed);
+        Entry& entry = result.first->second;
+        entry.value = move(value);
+        entry.referenced.store(true, memory_order_relaxed);
+        entry.dirty = true;
+        return Handle(move(guard), &entry.value);
+    }
+
+    // Under key's shard lock: if key has no entry, fills a new value with
+    // load and adds it unless load returns false. Returns true if key has
+    // an entry afterwards. Nothing can insert key while load runs.
+    bool insertLoaded(const string& key, const function<bool(T&)>& load, bool dirty = true) {
+        Shard& shard = shardFor(key);
+        unique_lock<shared_mutex> guard(shard.lock);
+        if (shard.entries.count(key) > 0) return true;
+        T value;
+        if (!load(value)) return false;
+        shard.entries.try_emplace(key, move(value), dirty);
+        count.fetch_add(1, memory_order_relaxed);
+        return true;
+    }
+
+    // Runs fn under key's shard lock if key has no entry, so fn can work on
+    // a copy of the value kept outside the table while nothing can insert
+    // key. False, without calling fn, if key has an entry.
+    bool whileAbsent(const string& key, const function<void()>& fn) {
+        Shard& shard = shardFor(key);
+        unique_lock<shared_mutex> guard(shard.lock);
+        if (shard.entries.count(key) > 0) return false;
+        fn();
+        return true;
+    }
+
+    bool contains(const string& key) {
+        Shard& shard = shardFor(key);
+        shared_lock<shared_mutex> guard(shard.lock);
+        return shard.entries.count(key) > 0;
+    }
+
+    size_t size() const {
+        return count.load(memory_order_relaxed);
+    }
+
+    // Visits every entry one shard at a time under that shard's lock
+    void forEach(const function<void(const string&, T&)>& fn) {
+        for (Shard& shard : shards) {
+            unique_lock<shared_mutex> guard(shard.lock);
+            for (auto& entry : shard.entries) {
+                fn(entry.first, entry.second.value);
+            }
+        }
+    }
+
+    // CLOCK sweep: removes entries not referenced since the last sweep until
+    // each shard holds at most its share of target entries. Referenced
+    // entries get their bit cleared and a second chance. onEvict sees each
+    // victim, with its dirty bit, under the shard lock just before it goes.
+    // Returns the number of entries removed.
+    size_t evict(size_t target, const function<void(const string&, T&, bool)>& onEvict) {
+        size_t limit = target / SHARD_COUNT;
+        size_t removed = 0;
+        vector<string> victims;
+
+        for (Shard& shard : shards) {
+            unique_lock<shared_mutex> guard(shard.lock);
+            auto& entries = shard.entries;
+            size_t buckets = entries.bucket_count();
+            // Two passes over the buckets clear every bit and then evict
+            for (size_t step = 0; entries.size() > limit && step < 2 * buckets; step++) {
+                size_t bucket = shard.hand++ % buckets;
+                victims.clear();
+                for (auto it = entries.begin(bucket); it != entries.end(bucket); ++it) {
+                    if (it->second.referenced.exchange(false, memory_order_relaxed)) continue;
+                    victims.push_back(it->first);
+                }
+                for (const string& key : victims) {
+                    if (entries.size() <= limit) break;
+                    auto it = entries.find(key);
+                    onEvict(it->first, it->second.value, it->second.dirty);
+                    entries.erase(it);
+                    removed++;
+                }
+            }
+        }
+        count.fetch_sub(removed, memory_order_relaxed);
+        return removed;
+    }
+};
+
+#endif
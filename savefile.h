@@ -0,0 +1,608 @@
+#ifndef SAVEFILE_H
+#define SAVEFILE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <functional>
+#include <iterator>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "gamedata.h"
+
+using namespace std;
+
+// ============================================================================
+// SAVE FILES
+// ============================================================================
+//
+// Binary player record (fixed-width fields, little-endian):
+//
+//   u32 magic "HTSV" | u16 version | u16 reserved | u32 payload length | payload
+//
+// Strings in the payload are a u16 length followed by the bytes; lists are a
+// count followed by their entries. Version 2 stores skills as a u8 count and
+// one i32 level per Skill in enum order; version 1 stored (name, level)
+// pairs and still loads. Version 3 stores the inventory as a u16 count of
+// (name, u32 quantity) stacks; earlier versions listed every item on its
+// own and load into stacks. A pack file is a "HTPK" header followed by
+// any number of records back to back, so a whole population loads with one
+// mmap and a linear walk.
+//
+// A delta record ("HTDT", same header layout) carries only the PlayerField
+// groups changed since the player's previous record:
+//
+//   str username | u32 PlayerField mask | i64 lastPlayed | groups in bit order
+//
+// and is applied on top of the full record it follows. Deltas only appear
+// in the save store; packs, journals and .sav files hold full records.
+
+const uint32_t SAVE_MAGIC = 0x56535448;   // "HTSV"
+const uint32_t PACK_MAGIC = 0x4b505448;   // "HTPK"
+const uint32_t DELTA_MAGIC = 0x54445448;  // "HTDT"
+const uint16_t SAVE_VERSION = 3;
+const size_t SAVE_HEADER_SIZE = 12;
+const size_t PACK_HEADER_SIZE = 8;
+
+class SaveWriter {
+private:
+    string& out;
+
+public:
+    SaveWriter(string& o) : out(o) {}
+
+    void raw(const void* data, size_t size) { out.append((const char*)data, size); }
+    void u8(uint8_t v) { raw(&v, 1); }
+    void u16(uint16_t v) { raw(&v, 2); }
+    void u32(uint32_t v) { raw(&v, 4); }
+    void u64(uint64_t v) { raw(&v, 8); }
+    void i32(int32_t v) { raw(&v, 4); }
+    void i64(int64_t v) { raw(&v, 8); }
+    void f32(float v) { raw(&v, 4); }
+    void str(const string& s) {
+        uint16_t size = (uint16_t)min(s.size(), (size_t)UINT16_MAX);
+        u16(size);
+        raw(s.data(), size);
+    }
+};
+
+// Bounds-checked reader; once a read runs past the end every later read
+// fails too and ok() turns false
+class SaveReader {
+private:
+    const char* pos;
+    const char* end;
+    bool good;
+
+    bool take(void* out, size_t size) {
+        if (!good || (size_t)(end - pos) < size) {
+            good = false;
+            return false;
+        }
+        memcpy(out, pos, size);
+        pos += size;
+        return true;
+    }
+
+public:
+    SaveReader(const char* data, size_t size) : pos(data), end(data + size), good(true) {}
+
+    bool ok() const { return good; }
+    size_t remaining() const { return end - pos; }
+
+    uint8_t u8() { uint8_t v = 0; take(&v, 1); return v; }
+    uint16_t u16() { uint16_t v = 0; take(&v, 2); return v; }
+    uint32_t u32() { uint32_t v = 0; take(&v, 4); return v; }
+    uint64_t u64() { uint64_t v = 0; take(&v, 8); return v; }
+    int32_t i32() { int32_t v = 0; take(&v, 4); return v; }
+    int64_t i64() { int64_t v = 0; take(&v, 8); return v; }
+    float f32() { float v = 0; take(&v, 4); return v; }
+    string str() {
+        uint16_t size = u16();
+        if (!good || remaining() < size) {
+            good = false;
+            return string();
+        }
+        string s(pos, size);
+        pos += size;
+        return s;
+    }
+    // A str() interned; fails like a short read once the symbol table is full
+    Symbol symbol() {
+        Symbol symbol = EMPTY_SYMBOL;
+        if (!tryIntern(str(), symbol)) good = false;
+        return symbol;
+    }
+};
+
+class SaveFile {
+private:
+    static void writeInventory(SaveWriter& w, const Player& player) {
+        w.u16((uint16_t)player.inventory.size());
+        for (const InventoryStack& stack : player.inventory) {
+            w.str(symbolName(stack.item));
+            w.u32((uint32_t)stack.count);
+        }
+    }
+
+    static void readInventory(SaveReader& r, uint16_t version, Player& player) {
+        player.inventory.clear();
+        if (version >= 3) {
+            uint16_t count = r.u16();
+            for (uint16_t i = 0; i < count && r.ok(); i++) {
+                Symbol item = r.symbol();
+                addToInventory(player.inventory, item, (int)min(r.u32(), (uint32_t)INT_MAX));
+            }
+        } else {
+            uint32_t count = r.u32();
+            for (uint32_t i = 0; i < count && r.ok(); i++) {
+                addToInventory(player.inventory, r.symbol(), 1);
+            }
+        }
+    }
+
+public:
+    // Appends one complete record for the player to out
+    static void encode(const Player& player, string& out) {
+        size_t start = out.size();
+        SaveWriter w(out);
+        w.u32(SAVE_MAGIC);
+        w.u16(SAVE_VERSION);
+        w.u16(0);
+        w.u32(0); // payload length, patched below
+
+        w.str(player.username);
+        w.str(symbolName(player.characterType));
+        w.i32(player.level);
+        w.i32(player.xp);
+        w.i32(player.xpToLevel);
+        w.i32(player.credits);
+        w.i32(player.reputation);
+        w.i32(player.heat);
+        w.i32(player.maxHeat);
+        w.f32(player.xpMultiplier);
+        w.i32(player.storyProgress);
+        w.str(symbolName(player.storyPath));
+        w.u8(player.seenBackstory);
+        w.i32(player.totalEarned);
+        w.i32(player.lowHeatMissions);
+        w.i32(player.missionStreak);
+        w.u8(player.doubleRewardNext);
+        w.u8(player.gameWon);
+        w.u8(player.gameLost);
+        w.i64(player.createdAt);
+        w.i64(player.lastPlayed);
+
+        w.u8((uint8_t)SKILL_COUNT);
+        for (int level : player.skills) {
+            w.i32(level);
+        }
+
+        w.u16((uint16_t)player.equipment.size());
+        for (Symbol item : player.equipment) {
+            w.str(symbolName(item));
+        }
+
+        writeInventory(w, player);
+
+        w.u64(player.completedMissions.to_ullong());
+        w.u32((uint32_t)player.achievements.to_ulong());
+
+        uint32_t payload = (uint32_t)(out.size() - start - SAVE_HEADER_SIZE);
+        memcpy(&out[start + 8], &payload, 4);
+    }
+
+    // Appends a delta record holding the given field groups of player plus
+    // lastPlayed
+    static void encodeDelta(const Player& player, unsigned fields, string& out) {
+        size_t start = out.size();
+        SaveWriter w(out);
+        w.u32(DELTA_MAGIC);
+        w.u16(SAVE_VERSION);
+        w.u16(0);
+        w.u32(0); // payload length, patched below
+
+        w.str(player.username);
+        w.u32(fields & FIELD_ALL);
+        w.i64(player.lastPlayed);
+
+        if (fields & FIELD_LEVEL) w.i32(player.level);
+        if (fields & FIELD_CREDITS) w.i32(player.credits);
+        if (fields & FIELD_EARNINGS) w.i32(player.totalEarned);
+        if (fields & FIELD_REPUTATION) w.i32(player.reputation);
+        if (fields & FIELD_HEAT) {
+            w.i32(player.heat);
+            w.i32(player.maxHeat);
+        }
+        if (fields & FIELD_LOW_HEAT) w.i32(player.lowHeatMissions);
+        if (fields & FIELD_STREAK) w.i32(player.missionStreak);
+        if (fields & FIELD_EQUIPMENT) {
+            w.u16((uint16_t)player.equipment.size());
+            for (Symbol item : player.equipment) {
+                w.str(symbolName(item));
+            }
+        }
+        if (fields & FIELD_SKILLS) {
+            w.u8((uint8_t)SKILL_COUNT);
+            for (int level : player.skills) {
+                w.i32(level);
+            }
+        }
+        if (fields & FIELD_MISSIONS) w.u64(player.completedMissions.to_ullong());
+        if (fields & FIELD_XP) {
+            w.i32(player.xp);
+            w.i32(player.xpToLevel);
+            w.f32(player.xpMultiplier);
+        }
+        if (fields & FIELD_INVENTORY) writeInventory(w, player);
+        if (fields & FIELD_ACHIEVEMENTS) w.u32((uint32_t)player.achievements.to_ulong());
+        if (fields & FIELD_STORY) {
+            w.i32(player.storyProgress);
+            w.str(symbolName(player.storyPath));
+            w.u8(player.seenBackstory);
+        }
+        if (fields & FIELD_FLAGS) {
+            w.u8(player.doubleRewardNext);
+            w.u8(player.gameWon);
+            w.u8(player.gameLost);
+        }
+
+        uint32_t payload = (uint32_t)(out.size() - start - SAVE_HEADER_SIZE);
+        memcpy(&out[start + 8], &payload, 4);
+    }
+
+    // Applies the delta record at the front of data to player, the state
+    // decoded from the records before it. Sets consumed like decode().
+    static bool applyDelta(const char* data, size_t size, Player& player, size_t& consumed) {
+        SaveReader header(data, size);
+        uint32_t magic = header.u32();
+        uint16_t version = header.u16();
+        header.u16();
+        uint32_t payload = header.u32();
+        if (!header.ok() || magic != DELTA_MAGIC || version == 0 || version > SAVE_VERSION) {
+            return false;
+        }
+        if (header.remaining() < payload) {
+            return false;
+        }
+
+        SaveReader r(data + SAVE_HEADER_SIZE, payload);
+        if (r.str() != player.username) {
+            return false;
+        }
+        unsigned fields = r.u32();
+        if (fields & ~(unsigned)FIELD_ALL) {
+            return false;
+        }
+        player.lastPlayed = (time_t)r.i64();
+
+        if (fields & FIELD_LEVEL) player.level = r.i32();
+        if (fields & FIELD_CREDITS) player.credits = r.i32();
+        if (fields & FIELD_EARNINGS) player.totalEarned = r.i32();
+        if (fields & FIELD_REPUTATION) player.reputation = r.i32();
+        if (fields & FIELD_HEAT) {
+            player.heat = r.i32();
+            player.maxHeat = r.i32();
+        }
+        if (fields & FIELD_LOW_HEAT) player.lowHeatMissions = r.i32();
+        if (fields & FIELD_STREAK) player.missionStreak = r.i32();
+        if (fields & FIELD_EQUIPMENT) {
+            uint16_t count = r.u16();
+            player.equipment.clear();
+            for (uint16_t i = 0; i < count && r.ok(); i++) {
+                player.equipment.push_back(r.symbol());
+            }
+        }
+        if (fields & FIELD_SKILLS) {
+            uint8_t skillCount = r.u8();
+            for (uint8_t i = 0; i < skillCount && r.ok(); i++) {
+                int level = r.i32();
+                if (i < SKILL_COUNT) player.skills[i] = level;
+            }
+        }
+        if (fields & FIELD_MISSIONS) player.completedMissions = bitset<MAX_MISSION_ID>(r.u64());
+        if (fields & FIELD_XP) {
+            player.xp = r.i32();
+            player.xpToLevel = r.i32();
+            player.xpMultiplier = r.f32();
+        }
+        if (fields & FIELD_INVENTORY) readInventory(r, version, player);
+        if (fields & FIELD_ACHIEVEMENTS) player.achievements = bitset<MAX_ACHIEVEMENTS>(r.u32());
+        if (fields & FIELD_STORY) {
+            player.storyProgress = r.i32();
+            player.storyPath = r.symbol();
+            player.seenBackstory = r.u8() != 0;
+        }
+        if (fields & FIELD_FLAGS) {
+            player.doubleRewardNext = r.u8() != 0;
+            player.gameWon = r.u8() != 0;
+            player.gameLost = r.u8() != 0;
+        }
+
+        if (!r.ok()) {
+            return false;
+        }
+        consumed = SAVE_HEADER_SIZE + payload;
+        return true;
+    }
+
+    // Whether the record at the front of data is a delta
+    static bool isDelta(const char* data, size_t size) {
+        uint32_t magic = 0;
+        if (size >= 4) memcpy(&magic, data, 4);
+        return magic == DELTA_MAGIC;
+    }
+
+    // Decodes one record from the front of data. On success fills player and
+    // sets consumed to the record's total size.
+    static bool decode(const char* data, size_t size, Player& player, size_t& consumed) {
+        SaveReader header(data, size);
+        uint32_t magic = header.u32();
+        uint16_t version = header.u16();
+        header.u16();
+        uint32_t payload = header.u32();
+        if (!header.ok() || magic != SAVE_MAGIC || version == 0 || version > SAVE_VERSION) {
+            return false;
+        }
+        if (header.remaining() < payload) {
+            return false;
+        }
+
+        SaveReader r(data + SAVE_HEADER_SIZE, payload);
+        player.username = r.str();
+        player.characterType = r.symbol();
+        player.level = r.i32();
+        player.xp = r.i32();
+        player.xpToLevel = r.i32();
+        player.credits = r.i32();
+        player.reputation = r.i32();
+        player.heat = r.i32();
+        player.maxHeat = r.i32();
+        player.xpMultiplier = r.f32();
+        player.storyProgress = r.i32();
+        player.storyPath = r.symbol();
+        player.seenBackstory = r.u8() != 0;
+        player.totalEarned = r.i32();
+        player.lowHeatMissions = r.i32();
+        player.missionStreak = r.i32();
+        player.doubleRewardNext = r.u8() != 0;
+        player.gameWon = r.u8() != 0;
+        player.gameLost = r.u8() != 0;
+        player.createdAt = (time_t)r.i64();
+        player.lastPlayed = (time_t)r.i64();
+
+        if (version >= 2) {
+            uint8_t skillCount = r.u8();
+            for (uint8_t i = 0; i < skillCount && r.ok(); i++) {
+                int level = r.i32();
+                if (i < SKILL_COUNT) player.skills[i] = level;
+            }
+        } else {
+            uint16_t skillCount = r.u16();
+            for (uint16_t i = 0; i < skillCount && r.ok(); i++) {
+                string name = r.str();
+                int level = r.i32();
+                Skill skill;
+                if (parseSkill(name, skill)) player.skills[skill] = level;
+            }
+        }
+
+        uint16_t equipmentCount = r.u16();
+        player.equipment.clear();
+        for (uint16_t i = 0; i < equipmentCount && r.ok(); i++) {
+            player.equipment.push_back(r.symbol());
+        }
+
+        readInventory(r, version, player);
+
+        player.completedMissions = bitset<MAX_MISSION_ID>(r.u64());
+        player.achievements = bitset<MAX_ACHIEVEMENTS>(r.u32());
+
+        if (!r.ok()) {
+            return false;
+        }
+        consumed = SAVE_HEADER_SIZE + payload;
+        return true;
+    }
+
+    static bool write(const string& path, const Player& player) {
+        string buffer;
+        encode(player, buffer);
+        ofstream file(path, ios::binary | ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+        file.write(buffer.data(), buffer.size());
+        return (bool)file;
+    }
+
+    static bool read(const string& path, Player& player) {
+        ifstream file(path, ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        string buffer((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+        size_t consumed = 0;
+        return decode(buffer.data(), buffer.size(), player, consumed);
+    }
+
+    // Starts a pack file image; follow with any number of encode() calls
+    static void encodePackHeader(string& out) {
+        SaveWriter w(out);
+        w.u32(PACK_MAGIC);
+        w.u16(SAVE_VERSION);
+        w.u16(0);
+    }
+
+    // Maps a pack file and hands each decoded player to sink. Returns the
+    // number of players read, or -1 if the file is missing or malformed.
+    static long readPack(const string& path, const function<void(Player&&)>& sink) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return -1;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < PACK_HEADER_SIZE) {
+            close(fd);
+            return -1;
+        }
+
+        size_t size = (size_t)st.st_size;
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED) {
+            return -1;
+        }
+        madvise(mapped, size, MADV_SEQUENTIAL);
+
+        const char* data = (const char*)mapped;
+        uint32_t magic;
+        memcpy(&magic, data, 4);
+        if (magic != PACK_MAGIC) {
+            munmap(mapped, size);
+            return -1;
+        }
+
+        long count = 0;
+        size_t offset = PACK_HEADER_SIZE;
+        while (offset < size) {
+            Player player;
+            size_t consumed = 0;
+            if (!decode(data + offset, size - offset, player, consumed)) {
+                munmap(mapped, size);
+                return -1;
+            }
+            offset += consumed;
+            sink(move(player));
+            count++;
+        }
+
+        munmap(mapped, size);
+        return count;
+    }
+
+    // "0x..." bitmask line from a legacy save; false unless the whole line
+    // (bar trailing whitespace) is hex digits that fit in 64 bits
+    static bool parseHexMask(const string& line, unsigned long long& mask) {
+        const char* digits = line.c_str() + 2;
+        if (!isxdigit((unsigned char)*digits)) return false;
+        char* end = nullptr;
+        errno = 0;
+        mask = strtoull(digits, &end, 16);
+        if (errno == ERANGE) return false;
+        while (isspace((unsigned char)*end)) end++;
+        return *end == '\0';
+    }
+
+    // Parses the original line-oriented text save (<username>_save.dat);
+    // false if it is missing or malformed
+    static bool readLegacy(const string& path, Player& player, const vector<Achievement>& achievements) {
+        ifstream file(path);
+
+        if (!file.is_open()) {
+            return false;
+        }
+
+        string characterType, storyPath;
+        file >> player.username;
+        file >> characterType;
+        file >> player.level;
+        file >> player.xp;
+        file >> player.xpToLevel;
+        file >> player.credits;
+        file >> player.reputation;
+        file >> player.heat;
+        file >> player.maxHeat;
+        file >> player.xpMultiplier;
+        file >> player.storyProgress;
+        file >> storyPath;
+        file >> player.seenBackstory;
+        file >> player.totalEarned;
+        file >> player.lowHeatMissions;
+        file >> player.missionStreak;
+        file >> player.doubleRewardNext;
+        file >> player.gameWon;
+        file >> player.gameLost;
+        if (!tryIntern(characterType, player.characterType) || !tryIntern(storyPath, player.storyPath)) {
+            return false;
+        }
+
+        // Skills
+        string line;
+        getline(file, line); // consume newline
+        while (getline(file, line) && line != "END_SKILLS") {
+            istringstream iss(line);
+            string skillName;
+            int skillLevel;
+            iss >> skillName >> skillLevel;
+            Skill skill;
+            if (parseSkill(skillName, skill)) {
+                player.skills[skill] = skillLevel;
+            }
+        }
+
+        // Equipment
+        while (getline(file, line) && line != "END_EQUIPMENT") {
+            Symbol item;
+            if (!line.empty()) {
+                if (!tryIntern(line, item)) return false;
+                player.equipment.push_back(item);
+            }
+        }
+
+        // Inventory
+        while (getline(file, line) && line != "END_INVENTORY") {
+            Symbol item;
+            if (!line.empty()) {
+                if (!tryIntern(line, item)) return false;
+                addToInventory(player.inventory, item, 1);
+            }
+        }
+
+        // Completed missions: a hex bitmask, or a list of ids in older saves
+        getline(file, line);
+        unsigned long long mask;
+        if (line.compare(0, 2, "0x") == 0) {
+            if (!parseHexMask(line, mask)) return false;
+            player.completedMissions = bitset<MAX_MISSION_ID>(mask);
+        } else {
+            istringstream iss(line);
+            int missionId;
+            while (iss >> missionId) {
+                if (missionId >= 0 && missionId < MAX_MISSION_ID) {
+                    player.completedMissions.set(missionId);
+                }
+            }
+        }
+        getline(file, line); // END_MISSIONS
+
+        // Achievements: a hex bitmask, or one id per line in older saves
+        while (getline(file, line) && line != "END_ACHIEVEMENTS") {
+            if (line.compare(0, 2, "0x") == 0) {
+                if (!parseHexMask(line, mask)) return false;
+                player.achievements = bitset<MAX_ACHIEVEMENTS>(mask);
+            } else if (!line.empty()) {
+                for (size_t i = 0; i < achievements.size(); i++) {
+                    if (achievements[i].id == line) {
+                        player.achievements.set(i);
+                        break;
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+};
+
+#endif
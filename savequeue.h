@@ -0,0 +1,198 @@
+#ifndef SAVEQUEUE_H
+#define SAVEQUEUE_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdio>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "gamedata.h"
+#include "savefile.h"
+
+using namespace std;
+
+// ============================================================================
+// SAVE QUEUE
+// ============================================================================
+//
+// Background persistence for player saves. The request thread only copies
+// the player into the queue; a writer thread encodes it and hands the
+// record to the queue's Writer. writeFile() is the plain-file writer: it
+// writes <path>.tmp with a single write() and renames it over <path>, so a
+// reader sees either the old save or the new one, never a torn file.
+//
+// Saves are coalesced per key: if a player is saved again before the
+// writer gets to them, the newer copy replaces the queued one and every
+// waiting caller is told the outcome of that one write. peek() sees a
+// player from the moment it is queued until its record is in place, so a
+// reader that misses the queue can go to the written copy.
+//
+// In incremental mode (for writers that keep a chain of records, like
+// SaveStore) a save only writes the PlayerField groups it was given, as a
+// SaveFile delta on top of the key's previous record. The writer reports
+// each key's current chain length; once a chain holds FOLD_EVERY deltas,
+// and whenever the key has no record or a delta is refused, the full
+// record is written instead.
+
+class SaveQueue {
+public:
+    typedef function<void(bool)> Callback;
+    typedef function<bool(const string& key, const string& record)> Writer;
+    // Records in key's chain (full record plus deltas), 0 if none
+    typedef function<size_t(const string& key)> ChainLength;
+
+private:
+    static const uint32_t FOLD_EVERY = 16;
+
+    struct Pending {
+        Player player;
+        unsigned fields = 0;             // union of the coalesced saves' changes
+        vector<Callback> callbacks;
+    };
+
+    mutex lock;                          // guards queued, writing, inFlight, stopping, chainLength
+    condition_variable work;
+    condition_variable drained;
+    Writer output;
+    unordered_map<string, Pending> queued;
+    unordered_map<string, Pending> writing;  // batch being written; only the writer mutates it
+    size_t inFlight;
+    bool stopping;
+    ChainLength chainLength;             // set in incremental mode
+    thread writer;
+
+public:
+    static bool writeFile(const string& path, const string& data) {
+        string tmp = path + ".tmp";
+        int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) return false;
+
+        size_t written = 0;
+        while (written < data.size()) {
+            ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            written += (size_t)n;
+        }
+        bool ok = ::close(fd) == 0 && written == data.size();
+        if (ok && rename(tmp.c_str(), path.c_str()) != 0) ok = false;
+        if (!ok) unlink(tmp.c_str());
+        return ok;
+    }
+
+private:
+    // Writes one pending save as a delta when the key's chain allows it,
+    // otherwise as a full record
+    bool write(const string& key, const Pending& pending, const ChainLength& chain, string& buffer) {
+        if (chain && pending.fields != FIELD_ALL) {
+            size_t length = chain(key);
+            if (length > 0 && length <= FOLD_EVERY) {
+                buffer.clear();
+                SaveFile::encodeDelta(pending.player, pending.fields, buffer);
+                if (output(key, buffer)) return true;
+            }
+        }
+
+        buffer.clear();
+        SaveFile::encode(pending.player, buffer);
+        return output(key, buffer);
+    }
+
+    void writeLoop() {
+        string buffer;
+        unique_lock<mutex> guard(lock);
+        while (true) {
+            work.wait(guard, [this] { return stopping || !queued.empty(); });
+            if (queued.empty()) break;  // stopping with nothing left
+
+            writing.swap(queued);
+            inFlight = writing.size();
+            ChainLength chain = chainLength;
+            guard.unlock();
+
+            for (const auto& entry : writing) {
+                bool ok = write(entry.first, entry.second, chain, buffer);
+                for (const Callback& done : entry.second.callbacks) {
+                    if (done) done(ok);
+                }
+            }
+
+            guard.lock();
+            writing.clear();
+            inFlight = 0;
+            if (queued.empty()) drained.notify_all();
+        }
+        drained.notify_all();
+    }
+
+public:
+    explicit SaveQueue(Writer sink = writeFile)
+        : output(move(sink)), inFlight(0), stopping(false) {
+        writer = thread(&SaveQueue::writeLoop, this);
+    }
+
+    // Writes out everything still queued before returning
+    ~SaveQueue() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        work.notify_all();
+        writer.join();
+    }
+
+    SaveQueue(const SaveQueue&) = delete;
+    SaveQueue& operator=(const SaveQueue&) = delete;
+
+    // Queues player to be written under key; done (if set) runs on the
+    // writer thread with the result once the record is in place. fields
+    // are the PlayerField groups changed since the key's previous save.
+    void save(const string& key, const Player& player, Callback done = nullptr, unsigned fields = FIELD_ALL) {
+        {
+            lock_guard<mutex> guard(lock);
+            Pending& pending = queued[key];
+            pending.player = player;
+            pending.fields |= fields;
+            pending.callbacks.push_back(move(done));
+        }
+        work.notify_one();
+    }
+
+    // Blocks until every save queued so far has been written
+    void flush() {
+        unique_lock<mutex> guard(lock);
+        drained.wait(guard, [this] { return queued.empty() && inFlight == 0; });
+    }
+
+    // Switch to delta records, sized against the chains length reports
+    // (nullptr switches back to full records); flush() first so no save
+    // straddles the change
+    void setIncremental(ChainLength length) {
+        lock_guard<mutex> guard(lock);
+        chainLength = move(length);
+    }
+
+    // Copies the newest not yet written save for key into player; false if
+    // nothing for key is queued or being written
+    bool peek(const string& key, Player& player) {
+        lock_guard<mutex> guard(lock);
+        auto it = queued.find(key);
+        if (it == queued.end()) {
+            it = writing.find(key);
+            if (it == writing.end()) return false;
+        }
+        player = it->second.player;
+        return true;
+    }
+};
+
+#endif
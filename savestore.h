@@ -0,0 +1,442 @@
+#ifndef SAVESTORE_H
+#define SAVESTORE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <filesystem>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "gamedata.h"
+#include "savefile.h"
+
+using namespace std;
+
+// ============================================================================
+// SAVE STORE
+// ============================================================================
+//
+// Packed replacement for one .sav file per player. Saves are appended to
+// numbered segment files (store.<n>.pack) inside one directory, and an
+// in-memory index maps each username to the segment, offset and size of
+// its newest full record and of every delta record written after it.
+// Every segment starts with a "HTPK" header followed by SaveFile records,
+// so a save is one pwrite and a load one pread per record in the chain,
+// and opening the store is one sequential read per segment.
+//
+// Superseded records stay behind as garbage. A background thread compacts
+// sealed segments whose live fraction drops below half: the chains with a
+// record in them are folded into one full record in the active segment and
+// the segments are deleted. A torn record at the end of the newest segment
+// is cut off when the store is opened.
+
+class SaveStore {
+private:
+    struct Segment {
+        uint64_t id;
+        string path;
+        int fd;
+        uint64_t size;       // bytes written, including the pack header
+
+        Segment(uint64_t i, const string& p, int f, uint64_t s) : id(i), path(p), fd(f), size(s) {}
+        ~Segment() { if (fd >= 0) ::close(fd); }
+    };
+
+    struct Location {
+        shared_ptr<Segment> segment;  // keeps the fd open while a read is in flight
+        uint64_t offset;
+        uint32_t size;
+    };
+
+    // Full record first, then the deltas to apply on top of it in order
+    typedef vector<Location> Chain;
+
+    string dir;
+    uint64_t segmentLimit;
+    int compactIntervalSec;
+
+    mutable shared_mutex indexLock;                // guards index
+    unordered_map<string, Chain> index;
+
+    mutex writeLock;                               // guards segments, active, nextId
+    map<uint64_t, shared_ptr<Segment>> segments;
+    shared_ptr<Segment> active;
+    uint64_t nextId;
+
+    mutex compactLock;                             // one compaction at a time
+    mutex wakeLock;                                // guards stopping
+    condition_variable wake;
+    bool stopping;
+    thread compactor;
+
+    static bool pwriteAll(int fd, const char* data, size_t size, uint64_t offset) {
+        while (size > 0) {
+            ssize_t n = ::pwrite(fd, data, size, (off_t)offset);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += n;
+            size -= (size_t)n;
+            offset += (uint64_t)n;
+        }
+        return true;
+    }
+
+    static bool preadAll(int fd, char* data, size_t size, uint64_t offset) {
+        while (size > 0) {
+            ssize_t n = ::pread(fd, data, size, (off_t)offset);
+            if (n <= 0) {
+                if (n < 0 && errno == EINTR) continue;
+                return false;
+            }
+            data += n;
+            size -= (size_t)n;
+            offset += (uint64_t)n;
+        }
+        return true;
+    }
+
+    string segmentPath(uint64_t id) const {
+        return dir + "/store." + to_string(id) + ".pack";
+    }
+
+    // Username and total size of the record at the front of data, without
+    // decoding the rest of it
+    static bool peekRecord(const char* data, size_t size, string& username, uint32_t& recordSize) {
+        SaveReader header(data, size);
+        uint32_t magic = header.u32();
+        header.u16();
+        header.u16();
+        uint32_t payload = header.u32();
+        if (!header.ok() || (magic != SAVE_MAGIC && magic != DELTA_MAGIC) || header.remaining() < payload) {
+            return false;
+        }
+        SaveReader body(data + SAVE_HEADER_SIZE, payload);
+        username = body.str();
+        recordSize = (uint32_t)(SAVE_HEADER_SIZE + payload);
+        return body.ok();
+    }
+
+    bool syncDir() const {
+        int fd = ::open(dir.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        bool ok = fsync(fd) == 0;
+        ::close(fd);
+        return ok;
+    }
+
+    // Starts a new empty segment; caller holds writeLock
+    bool openSegment() {
+        uint64_t id = nextId++;
+        string path = segmentPath(id);
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) return false;
+
+        string header;
+        SaveFile::encodePackHeader(header);
+        if (!pwriteAll(fd, header.data(), header.size(), 0)) {
+            ::close(fd);
+            return false;
+        }
+        active = make_shared<Segment>(id, path, fd, header.size());
+        segments[id] = active;
+        return true;
+    }
+
+    // Appends one record and adds it to username's chain: a full record
+    // starts a new chain, a delta extends the current one. A delta with no
+    // chain to extend is refused. Caller holds writeLock.
+    bool appendLocked(const string& username, const char* record, size_t size) {
+        bool delta = SaveFile::isDelta(record, size);
+        if (delta && !contains(username)) return false;
+
+        if (active->size + size > segmentLimit && active->size > PACK_HEADER_SIZE) {
+            if (!openSegment()) return false;
+        }
+        uint64_t offset = active->size;
+        if (!pwriteAll(active->fd, record, size, offset)) return false;
+        active->size += size;
+
+        unique_lock<shared_mutex> guard(indexLock);
+        Chain& chain = index[username];
+        if (!delta) chain.clear();
+        chain.push_back(Location{active, offset, (uint32_t)size});
+        return true;
+    }
+
+    // Decodes a chain's full record and applies its deltas
+    static bool readChain(const Chain& chain, Player& player) {
+        thread_local string buffer;
+        size_t consumed = 0;
+        for (size_t i = 0; i < chain.size(); i++) {
+            const Location& location = chain[i];
+            buffer.resize(location.size);
+            if (!preadAll(location.segment->fd, &buffer[0], location.size, location.offset)) {
+                return false;
+            }
+            bool ok = i == 0 ? SaveFile::decode(buffer.data(), buffer.size(), player, consumed)
+                             : SaveFile::applyDelta(buffer.data(), buffer.size(), player, consumed);
+            if (!ok) return false;
+        }
+        return !chain.empty();
+    }
+
+    // Reads every record in one segment file into the index. A torn tail is
+    // truncated away when the segment is the newest one.
+    bool scanSegment(uint64_t id, bool newest) {
+        string path = segmentPath(id);
+        int fd = ::open(path.c_str(), O_RDWR);
+        if (fd < 0) return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+        string data((size_t)st.st_size, '\0');
+        if (!preadAll(fd, &data[0], data.size(), 0)) {
+            ::close(fd);
+            return false;
+        }
+        uint32_t magic = 0;
+        if (data.size() >= PACK_HEADER_SIZE) memcpy(&magic, data.data(), 4);
+        if (magic != PACK_MAGIC) {
+            ::close(fd);
+            return false;
+        }
+
+        auto segment = make_shared<Segment>(id, path, fd, PACK_HEADER_SIZE);
+        uint64_t offset = PACK_HEADER_SIZE;
+        string username;
+        uint32_t recordSize;
+        while (offset < data.size() &&
+               peekRecord(data.data() + offset, data.size() - offset, username, recordSize)) {
+            Location location{segment, offset, recordSize};
+            if (!SaveFile::isDelta(data.data() + offset, recordSize)) {
+                index[username] = Chain{location};
+            } else {
+                auto it = index.find(username);
+                if (it != index.end()) it->second.push_back(location);
+            }
+            offset += recordSize;
+        }
+        segment->size = offset;
+        if (offset < data.size() && newest && ftruncate(fd, (off_t)offset) != 0) {
+            return false;
+        }
+        segments[id] = segment;
+        return true;
+    }
+
+    void compactLoop() {
+        unique_lock<mutex> guard(wakeLock);
+        while (!stopping) {
+            wake.wait_for(guard, chrono::seconds(compactIntervalSec));
+            if (stopping) break;
+            guard.unlock();
+            compact();
+            guard.lock();
+        }
+    }
+
+public:
+    SaveStore() : segmentLimit(64u << 20), compactIntervalSec(30), nextId(1), stopping(false) {}
+
+    ~SaveStore() {
+        {
+            lock_guard<mutex> guard(wakeLock);
+            stopping = true;
+        }
+        wake.notify_all();
+        if (compactor.joinable()) compactor.join();
+    }
+
+    SaveStore(const SaveStore&) = delete;
+    SaveStore& operator=(const SaveStore&) = delete;
+
+    // Opens or creates the store in dir and indexes every record in it.
+    // Returns the number of players found, or -1 on failure.
+    long open(const string& path, int intervalSec = 30, uint64_t limit = 64u << 20) {
+        dir = path;
+        segmentLimit = limit;
+        compactIntervalSec = max(1, intervalSec);
+
+        error_code ec;
+        filesystem::create_directories(dir, ec);
+
+        vector<uint64_t> ids;
+        for (const auto& entry : filesystem::directory_iterator(dir, ec)) {
+            string name = entry.path().filename().string();
+            if (name.compare(0, 6, "store.") != 0 || name.size() <= 11 ||
+                name.compare(name.size() - 5, 5, ".pack") != 0) {
+                continue;
+            }
+            ids.push_back(strtoull(name.c_str() + 6, nullptr, 10));
+        }
+        if (ec) return -1;
+        sort(ids.begin(), ids.end());
+
+        lock_guard<mutex> guard(writeLock);
+        for (size_t i = 0; i < ids.size(); i++) {
+            if (!scanSegment(ids[i], i + 1 == ids.size())) return -1;
+        }
+        nextId = ids.empty() ? 1 : ids.back() + 1;
+        if (!segments.empty() && segments.rbegin()->second->size < segmentLimit) {
+            active = segments.rbegin()->second;
+        } else if (!openSegment()) {
+            return -1;
+        }
+
+        compactor = thread(&SaveStore::compactLoop, this);
+        return (long)index.size();
+    }
+
+    // Stores one encoded SaveFile record as username's newest save
+    bool write(const string& username, const string& record) {
+        lock_guard<mutex> guard(writeLock);
+        return appendLocked(username, record.data(), record.size());
+    }
+
+    bool read(const string& username, Player& player) const {
+        Chain chain;
+        {
+            shared_lock<shared_mutex> guard(indexLock);
+            auto it = index.find(username);
+            if (it == index.end()) return false;
+            chain = it->second;
+        }
+        return readChain(chain, player);
+    }
+
+    // Records in username's chain: its full record plus the deltas on top,
+    // 0 if the store has no save for username
+    size_t chainLength(const string& username) const {
+        shared_lock<shared_mutex> guard(indexLock);
+        auto it = index.find(username);
+        return it == index.end() ? 0 : it->second.size();
+    }
+
+    bool contains(const string& username) const {
+        shared_lock<shared_mutex> guard(indexLock);
+        return index.count(username) > 0;
+    }
+
+    size_t size() const {
+        shared_lock<shared_mutex> guard(indexLock);
+        return index.size();
+    }
+
+    // Makes every record written so far durable: writes are plain pwrites,
+    // so a crash can lose any of them until this returns true
+    bool sync() {
+        vector<shared_ptr<Segment>> current;
+        {
+            lock_guard<mutex> guard(writeLock);
+            for (const auto& entry : segments) current.push_back(entry.second);
+        }
+        for (const auto& segment : current) {
+            if (fdatasync(segment->fd) != 0) return false;
+        }
+        return syncDir();
+    }
+
+    // Rewrites the chains with records in sealed segments that are mostly
+    // garbage as single full records, then deletes those segments. Returns
+    // the number of segments removed.
+    int compact() {
+        lock_guard<mutex> compacting(compactLock);
+
+        // Live bytes per segment, from the index
+        unordered_map<uint64_t, uint64_t> live;
+        {
+            shared_lock<shared_mutex> guard(indexLock);
+            for (const auto& entry : index) {
+                for (const Location& location : entry.second) {
+                    live[location.segment->id] += location.size;
+                }
+            }
+        }
+
+        vector<shared_ptr<Segment>> victims;
+        {
+            lock_guard<mutex> guard(writeLock);
+            for (const auto& entry : segments) {
+                const Segment& segment = *entry.second;
+                if (entry.second == active) continue;
+                if (live[segment.id] * 2 < segment.size - PACK_HEADER_SIZE) {
+                    victims.push_back(entry.second);
+                }
+            }
+        }
+        if (victims.empty()) return 0;
+
+        string record;
+        vector<shared_ptr<Segment>> written;  // every segment the copies went to
+        for (const auto& victim : victims) {
+            vector<pair<string, Chain>> moving;
+            {
+                shared_lock<shared_mutex> guard(indexLock);
+                for (const auto& entry : index) {
+                    for (const Location& location : entry.second) {
+                        if (location.segment == victim) {
+                            moving.push_back(entry);
+                            break;
+                        }
+                    }
+                }
+            }
+
+            for (const auto& entry : moving) {
+                Player player;
+                if (!readChain(entry.second, player)) return -1;
+                record.clear();
+                SaveFile::encode(player, record);
+
+                lock_guard<mutex> guard(writeLock);
+                {
+                    // Skip players saved again since the index was read
+                    shared_lock<shared_mutex> indexGuard(indexLock);
+                    auto it = index.find(entry.first);
+                    const Location& last = entry.second.back();
+                    if (it == index.end() || it->second.size() != entry.second.size() ||
+                        it->second.back().segment != last.segment || it->second.back().offset != last.offset) {
+                        continue;
+                    }
+                }
+                if (!appendLocked(entry.first, record.data(), record.size())) return -1;
+                if (written.empty() || written.back() != active) written.push_back(active);
+            }
+        }
+
+        // The copies, and the directory entries of any segments they rolled
+        // over into, must be durable before the originals go away
+        for (const auto& segment : written) {
+            if (fdatasync(segment->fd) != 0) return -1;
+        }
+        if (!syncDir()) return -1;
+        {
+            lock_guard<mutex> guard(writeLock);
+            for (const auto& victim : victims) {
+                unlink(victim->path.c_str());
+                segments.erase(victim->id);
+            }
+        }
+        return syncDir() ? (int)victims.size() : -1;
+    }
+};
+
+#endif
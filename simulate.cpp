@@ -0,0 +1,386 @@
+// Build: g++ -std=c++17 -O2 simulate.cpp -o simulate -lpthread
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <deque>
+#include <cstdlib>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+
+#include "gamerules.h"
+
+using namespace std;
+
+// ============================================================================
+// BALANCE SIMULATOR
+// ============================================================================
+//
+// Plays millions of independent games with the server's own rules
+// (GameRules) and reports how they end, how many missions it takes to reach
+// level 20 and how credits and level grow over a playthrough.
+//
+//   simulate [--games 1000000] [--strategy <name>|all] [--success 75]
+//            [--max-missions 200] [--threads <n>] [--seed <n>]
+//
+// Each game draws from its own generator seeded from --seed and the game's
+// index, so results do not depend on the thread count or scheduling.
+
+struct SimConfig {
+    long games;
+    int successRate;     // percent chance a mission attempt succeeds
+    int maxMissions;     // attempts before a game is abandoned
+    unsigned threads;
+    uint64_t seed;
+};
+
+// ============================================================================
+// STRATEGIES
+// ============================================================================
+//
+// A strategy plays one turn: it may buy, upgrade, cool down or pick a story
+// path through the rules, then names the mission to attempt, or -1 when it
+// has nothing left to play.
+
+struct Strategy {
+    const char* name;
+    const char* description;
+    int (*turn)(const GameRules& rules, Player& player);
+};
+
+// Best-scoring mission the player can attempt now, or -1
+template <typename Score>
+static int pickMission(const GameRules& rules, const Player& player, Score score) {
+    const Mission* best = nullptr;
+    double bestScore = 0;
+    for (const Mission* mission : rules.getAvailableMissions(player)) {
+        if (mission->reqLevel > player.level || player.completedMissions.test(mission->id)) {
+            continue;
+        }
+        double s = score(*mission);
+        if (!best || s > bestScore) {
+            best = mission;
+            bestScore = s;
+        }
+    }
+    return best ? best->id : -1;
+}
+
+static void buyAffordable(const GameRules& rules, Player& player, const vector<const char*>& wanted) {
+    for (const char* itemId : wanted) {
+        const ShopItem* item = rules.findItem(itemId);
+        if (item && player.credits >= item->price) {
+            rules.buyItem(player, *item);
+        }
+    }
+}
+
+static int greedyTurn(const GameRules& rules, Player& player) {
+    if (player.storyPath == SYM_INTRO && player.level >= 4) {
+        rules.storyChoice(player, "aggressive");
+    }
+    if (player.heat >= 60) {
+        rules.reduceHeat(player);
+    }
+    return pickMission(rules, player, [](const Mission& m) { return (double)m.creditsReward; });
+}
+
+static int cautiousTurn(const GameRules& rules, Player& player) {
+    if (player.storyPath == SYM_INTRO && player.level >= 4) {
+        rules.storyChoice(player, "stealth");
+    }
+    buyAffordable(rules, player, {"vpn", "server", "quantum"});
+    while (player.heat >= 30 && rules.reduceHeat(player) == RULE_OK) {
+    }
+    return pickMission(rules, player, [](const Mission& m) { return -m.heat * 1000.0 + m.xpReward; });
+}
+
+static int recklessTurn(const GameRules& rules, Player& player) {
+    if (player.storyPath == SYM_INTRO && player.level >= 4) {
+        rules.storyChoice(player, "aggressive");
+    }
+    return pickMission(rules, player, [](const Mission& m) { return (double)m.xpReward; });
+}
+
+static int balancedTurn(const GameRules& rules, Player& player) {
+    if (player.storyPath == SYM_INTRO && player.level >= 4) {
+        rules.storyChoice(player, "neutral");
+    }
+    buyAffordable(rules, player, {"laptop", "vpn", "ai"});
+    if (player.heat >= 50) {
+        rules.reduceHeat(player);
+    }
+    return pickMission(rules, player, [&](const Mission& m) {
+        return (double)m.xpReward / (1 + max(0, m.heat - rules.calculateHeatReduction(player)));
+    });
+}
+
+static const vector<Strategy>& strategies() {
+    static const vector<Strategy> list = {
+        {"greedy", "highest-paying mission, cools down at 60 heat", greedyTurn},
+        {"cautious", "lowest-heat mission, buys heat gear, cools down at 30 heat", cautiousTurn},
+        {"reckless", "highest-XP mission, never cools down", recklessTurn},
+        {"balanced", "best XP per heat, buys XP gear, cools down at 50 heat", balancedTurn},
+    };
+    return list;
+}
+
+// ============================================================================
+// RESULTS
+// ============================================================================
+
+// One per worker, padded so workers never share a cache line
+struct alignas(64) SimStats {
+    long games;
+    long won;
+    long lost;
+    long stalled;        // nothing left to attempt before level 20
+    long abandoned;      // hit --max-missions
+    long missions;
+    vector<long> winAt;          // missions attempted -> games won there
+    vector<double> creditSum;    // per mission attempted, summed over games
+    vector<double> levelSum;
+    vector<long> reached;        // games that attempted at least that many
+
+    SimStats(int maxMissions)
+        : games(0), won(0), lost(0), stalled(0), abandoned(0), missions(0),
+          winAt(maxMissions + 1, 0), creditSum(maxMissions + 1, 0),
+          levelSum(maxMissions + 1, 0), reached(maxMissions + 1, 0) {}
+
+    void merge(const SimStats& other) {
+        games += other.games;
+        won += other.won;
+        lost += other.lost;
+        stalled += other.stalled;
+        abandoned += other.abandoned;
+        missions += other.missions;
+        for (size_t i = 0; i < winAt.size(); i++) {
+            winAt[i] += other.winAt[i];
+            creditSum[i] += other.creditSum[i];
+            levelSum[i] += other.levelSum[i];
+            reached[i] += other.reached[i];
+        }
+    }
+};
+
+static void playGame(const GameRules& rules, const Strategy& strategy, const SimConfig& config,
+                     long index, SimStats& stats) {
+    static const Symbol characters[] = {SYM_GHOST, SYM_CIPHER, SYM_REBEL, SYM_ARCHITECT};
+    Rng rng(config.seed ^ ((uint64_t)index * 0x9e3779b97f4a7c15ull));
+    Player player = rules.newPlayer("sim", characters[index & 3]);
+
+    int attempts = 0;
+    stats.games++;
+    stats.creditSum[0] += player.credits;
+    stats.levelSum[0] += player.level;
+    stats.reached[0]++;
+
+    for (;;) {
+        if (attempts >= config.maxMissions) {
+            stats.abandoned++;
+            break;
+        }
+        int missionId = strategy.turn(rules, player);
+        if (missionId < 0) {
+            stats.stalled++;
+            break;
+        }
+
+        rules.runMission(player, missionId, config.successRate, rng);
+        attempts++;
+        stats.creditSum[attempts] += player.credits;
+        stats.levelSum[attempts] += player.level;
+        stats.reached[attempts]++;
+
+        if (player.gameWon) {
+            stats.won++;
+            stats.winAt[attempts]++;
+            break;
+        }
+        if (player.gameLost) {
+            stats.lost++;
+            break;
+        }
+    }
+    stats.missions += attempts;
+}
+
+static long percentile(const vector<long>& histogram, long total, double q) {
+    long target = (long)(q * total);
+    long seen = 0;
+    for (size_t i = 0; i < histogram.size(); i++) {
+        seen += histogram[i];
+        if (seen > target) return (long)i;
+    }
+    return (long)histogram.size() - 1;
+}
+
+static void report(const Strategy& strategy, const SimStats& stats, double seconds) {
+    auto pct = [&](long n) { return stats.games ? 100.0 * n / stats.games : 0.0; };
+
+    cout << "\n=== " << strategy.name << " ===  (" << strategy.description << ")" << endl;
+    cout << fixed << setprecision(2);
+    cout << stats.games << " games, " << stats.missions << " missions in " << seconds << "s ("
+         << (seconds > 0 ? stats.missions / seconds / 1e6 : 0) << "M missions/s)" << endl;
+    cout << setprecision(1);
+    cout << "Won: " << pct(stats.won) << "%  Lost at 100 heat: " << pct(stats.lost)
+         << "%  Stalled: " << pct(stats.stalled) << "%  Abandoned: " << pct(stats.abandoned) << "%" << endl;
+
+    if (stats.won > 0) {
+        cout << "Missions to level 20: p10=" << percentile(stats.winAt, stats.won, 0.10)
+             << " p50=" << percentile(stats.winAt, stats.won, 0.50)
+             << " p90=" << percentile(stats.winAt, stats.won, 0.90)
+             << " p99=" << percentile(stats.winAt, stats.won, 0.99) << endl;
+    } else {
+        cout << "Missions to level 20: no game got there" << endl;
+    }
+
+    cout << "Mission | still playing | avg credits | avg level" << endl;
+    for (size_t i = 0; i < stats.reached.size(); i += 5) {
+        if (stats.reached[i] == 0) break;
+        cout << setw(7) << i << " | " << setw(12) << pct(stats.reached[i]) << "% | "
+             << setw(11) << stats.creditSum[i] / stats.reached[i] << " | "
+             << setw(9) << stats.levelSum[i] / stats.reached[i] << endl;
+    }
+}
+
+// ============================================================================
+// WORK-STEALING POOL
+// ============================================================================
+//
+// Games are cut into fixed-size batches dealt round-robin onto one deque per
+// worker. A worker takes batches from the back of its own deque and, once
+// that is empty, steals from the front of the others.
+
+class WorkStealingPool {
+private:
+    struct Batch {
+        long begin;
+        long end;
+    };
+
+    struct alignas(64) Queue {
+        mutex lock;
+        deque<Batch> batches;
+    };
+
+    vector<Queue> queues;
+
+    bool take(size_t worker, Batch& batch) {
+        Queue& own = queues[worker];
+        {
+            lock_guard<mutex> guard(own.lock);
+            if (!own.batches.empty()) {
+                batch = own.batches.back();
+                own.batches.pop_back();
+                return true;
+            }
+        }
+        for (size_t i = 1; i < queues.size(); i++) {
+            Queue& victim = queues[(worker + i) % queues.size()];
+            lock_guard<mutex> guard(victim.lock);
+            if (!victim.batches.empty()) {
+                batch = victim.batches.front();
+                victim.batches.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    WorkStealingPool(unsigned workers) : queues(workers) {}
+
+    // Runs fn(worker, index) for every index in [0, count)
+    template <typename Fn>
+    void run(long count, long batchSize, Fn fn) {
+        size_t next = 0;
+        for (long begin = 0; begin < count; begin += batchSize) {
+            queues[next].batches.push_back({begin, min(count, begin + batchSize)});
+            next = (next + 1) % queues.size();
+        }
+
+        vector<thread> threads;
+        for (size_t worker = 0; worker < queues.size(); worker++) {
+            threads.emplace_back([this, worker, &fn] {
+                Batch batch;
+                while (take(worker, batch)) {
+                    for (long i = batch.begin; i < batch.end; i++) {
+                        fn(worker, i);
+                    }
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+};
+
+// ============================================================================
+// MAIN FUNCTION
+// ============================================================================
+
+int main(int argc, char* argv[]) {
+    SimConfig config;
+    config.games = 1000000;
+    config.successRate = 75;
+    config.maxMissions = 200;
+    config.threads = max(1u, thread::hardware_concurrency());
+    config.seed = 1;
+    string only = "all";
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--games" && i + 1 < argc) {
+            config.games = atol(argv[++i]);
+        } else if (arg == "--strategy" && i + 1 < argc) {
+            only = argv[++i];
+        } else if (arg == "--success" && i + 1 < argc) {
+            config.successRate = atoi(argv[++i]);
+        } else if (arg == "--max-missions" && i + 1 < argc) {
+            config.maxMissions = max(1, atoi(argv[++i]));
+        } else if (arg == "--threads" && i + 1 < argc) {
+            config.threads = max(1, atoi(argv[++i]));
+        } else if (arg == "--seed" && i + 1 < argc) {
+            config.seed = strtoull(argv[++i], nullptr, 10);
+        }
+    }
+
+    GameRules rules;
+    cout << "Simulating " << config.games << " games per strategy on " << config.threads
+         << " threads (success " << config.successRate << "%, seed " << config.seed << ")" << endl;
+
+    bool ran = false;
+    for (const Strategy& strategy : strategies()) {
+        if (only != "all" && only != strategy.name) continue;
+        ran = true;
+
+        vector<SimStats> perWorker(config.threads, SimStats(config.maxMissions));
+        WorkStealingPool pool(config.threads);
+        auto started = chrono::steady_clock::now();
+        pool.run(config.games, 1024, [&](size_t worker, long index) {
+            playGame(rules, strategy, config, index, perWorker[worker]);
+        });
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+
+        SimStats total(config.maxMissions);
+        for (const SimStats& stats : perWorker) {
+            total.merge(stats);
+        }
+        report(strategy, total, seconds);
+    }
+
+    if (!ran) {
+        cout << "ERROR: Unknown strategy " << only << " (choose from";
+        for (const Strategy& strategy : strategies()) cout << " " << strategy.name;
+        cout << " or all)" << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,124 @@
+#ifndef SYMBOLS_H
+#define SYMBOLS_H
+
+#include <string>
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+
+using namespace std;
+
+// ============================================================================
+// SYMBOLS
+// ============================================================================
+//
+// Process-wide intern table for the small vocabularies the game stores per
+// player (character types, story paths, item ids, loot names, event
+// effects). Each distinct string gets a 16-bit Symbol once and keeps it for
+// the life of the process, so players store two bytes instead of a string
+// copy and comparisons are integer compares. Reading a symbol's name
+// takes no lock; finding a name's symbol takes the lock shared, and only
+// interning a string not seen before takes it exclusively.
+//
+// The table holds at most 65536 names and never shrinks, so client input is
+// only ever looked up with find(), never interned; names from saves go
+// through tryIntern(), which fails once the table is full instead of
+// aliasing the name to another symbol.
+
+typedef uint16_t Symbol;
+
+const Symbol EMPTY_SYMBOL = 0;
+
+class SymbolTable {
+private:
+    static const size_t CHUNK_SIZE = 256;
+    static const size_t MAX_SYMBOLS = 65536;
+
+    mutable shared_mutex lock;                 // guards index and appends
+    unordered_map<string, Symbol> index;
+    // Names live in fixed chunks that never move, so name() needs no lock
+    unique_ptr<string[]> chunks[MAX_SYMBOLS / CHUNK_SIZE];
+    atomic<size_t> count;
+
+public:
+    SymbolTable() : count(0) {
+        intern("");
+    }
+
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    // Symbol for text, adding it if it is new; false if the table is full
+    bool tryIntern(const string& text, Symbol& symbol) {
+        if (find(text, symbol)) return true;
+
+        unique_lock<shared_mutex> guard(lock);
+        auto it = index.find(text);
+        if (it != index.end()) {
+            symbol = it->second;
+            return true;
+        }
+
+        size_t next = count.load(memory_order_relaxed);
+        if (next >= MAX_SYMBOLS) return false;
+
+        unique_ptr<string[]>& chunk = chunks[next / CHUNK_SIZE];
+        if (!chunk) chunk.reset(new string[CHUNK_SIZE]);
+        chunk[next % CHUNK_SIZE] = text;
+        index.emplace(text, (Symbol)next);
+        count.store(next + 1, memory_order_release);
+        symbol = (Symbol)next;
+        return true;
+    }
+
+    // For the game's own vocabulary, interned at startup while the table
+    // is nearly empty
+    Symbol intern(const string& text) {
+        Symbol symbol = EMPTY_SYMBOL;
+        tryIntern(text, symbol);
+        return symbol;
+    }
+
+    // Symbol for text if it has been interned, without adding it
+    bool find(const string& text, Symbol& symbol) const {
+        shared_lock<shared_mutex> guard(lock);
+        auto it = index.find(text);
+        if (it == index.end()) return false;
+        symbol = it->second;
+        return true;
+    }
+
+    const string& name(Symbol symbol) const {
+        return chunks[symbol / CHUNK_SIZE][symbol % CHUNK_SIZE];
+    }
+
+    size_t size() const {
+        return count.load(memory_order_acquire);
+    }
+};
+
+inline SymbolTable& symbols() {
+    static SymbolTable table;
+    return table;
+}
+
+inline Symbol intern(const string& text) {
+    return symbols().intern(text);
+}
+
+inline bool tryIntern(const string& text, Symbol& symbol) {
+    return symbols().tryIntern(text, symbol);
+}
+
+inline bool findSymbol(const string& text, Symbol& symbol) {
+    return symbols().find(text, symbol);
+}
+
+inline const string& symbolName(Symbol symbol) {
+    return symbols().name(symbol);
+}
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef TEXTFORMAT_H
+#define TEXTFORMAT_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+using namespace std;
+
+// ============================================================================
+// TEXT FORMATTING
+// ============================================================================
+//
+// Append-only helpers for rendering responses into a std::string that the
+// caller reuses. Nothing here goes through iostreams or locales, and once
+// the target string has grown to fit a response, rendering into it again
+// does not allocate.
+
+// Decimal digits of 00..99, two characters per entry
+inline const char* digitPairs() {
+    static const char pairs[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+    return pairs;
+}
+
+inline void appendInt(string& out, long long value) {
+    char digits[24];
+    char* end = digits + sizeof(digits);
+    char* p = end;
+
+    unsigned long long magnitude = value < 0 ? 0ull - (unsigned long long)value : (unsigned long long)value;
+    while (magnitude >= 100) {
+        const char* pair = digitPairs() + (magnitude % 100) * 2;
+        magnitude /= 100;
+        *--p = pair[1];
+        *--p = pair[0];
+    }
+    if (magnitude >= 10) {
+        const char* pair = digitPairs() + magnitude * 2;
+        *--p = pair[1];
+        *--p = pair[0];
+    } else {
+        *--p = (char)('0' + magnitude);
+    }
+    if (value < 0) *--p = '-';
+
+    out.append(p, end - p);
+}
+
+// Appends text as a quoted JSON string. Only quotes, backslashes and control
+// characters are escaped; UTF-8 passes through unchanged.
+inline void appendJsonString(string& out, string_view text) {
+    static const char hex[] = "0123456789abcdef";
+    out += '"';
+    size_t run = 0;  // start of the pending unescaped run
+    for (size_t i = 0; i < text.size(); i++) {
+        unsigned char c = (unsigned char)text[i];
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        out.append(text.data() + run, i - run);
+        run = i + 1;
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                out += "\\u00";
+                out += hex[c >> 4];
+                out += hex[c & 0xf];
+        }
+    }
+    out.append(text.data() + run, text.size() - run);
+    out += '"';
+}
+
+// Streaming JSON writer for hot response shapes. Appends straight to out
+// and only tracks where a comma is due, so nothing is built in between;
+// the caller is responsible for balancing begin/end calls.
+class JsonWriter {
+private:
+    string& out;
+    bool needComma;
+
+    void separate() {
+        if (needComma) out += ',';
+        needComma = true;
+    }
+
+public:
+    explicit JsonWriter(string& out) : out(out), needComma(false) {}
+
+    JsonWriter& beginObject() { separate(); out += '{'; needComma = false; return *this; }
+    JsonWriter& endObject() { out += '}'; needComma = true; return *this; }
+    JsonWriter& beginArray() { separate(); out += '['; needComma = false; return *this; }
+    JsonWriter& endArray() { out += ']'; needComma = true; return *this; }
+
+    JsonWriter& key(string_view name) {
+        separate();
+        appendJsonString(out, name);
+        out += ':';
+        needComma = false;
+        return *this;
+    }
+
+    JsonWriter& number(long long value) { separate(); appendInt(out, value); return *this; }
+    JsonWriter& text(string_view value) { separate(); appendJsonString(out, value); return *this; }
+    JsonWriter& boolean(bool value) { separate(); out += value ? "true" : "false"; return *this; }
+};
+
+// Per-thread scratch string for rendering a response. Cleared on every call,
+// so finish with the previous contents before asking for it again.
+inline string& scratchBuffer() {
+    thread_local string buffer;
+    buffer.clear();
+    return buffer;
+}
+
+#endif